@@ -12,10 +12,18 @@
 #ifndef CppLog_H_
 #define CppLog_H_
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
+#include <condition_variable>
+#include <ctime>
 #include <fstream>
-#include <queue>
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
+#include "LogRing.h"
+#include "LogBinary.h"
 
 /*
 ***************************日志文件写入模式***************************
@@ -39,34 +47,83 @@ enum class TimeFormat {
 };
 
 
+/*
+***************************时间缓存***************************
+*/
+// 日志线程格式化写入时刻用，缓存上一次的时间字符串: 同一秒内只改写秒以下的数字，同一分钟内只改写秒的两位数字
+class TimeCache {
+private:
+    char m_text[32];  // 上一次的时间字符串
+    size_t m_length = 0;  // m_text 的长度
+    size_t m_sec_pos = 0;  // 秒的两位数字在 m_text 中的位置
+    int64_t m_second = -1;  // m_text 对应的秒，-1 表示缓存无效
+    TimeFormat m_format = TimeFormat::FULLA;  // m_text 的时间格式
+    int m_precision = 0;  // m_text 秒以下的位数
+
+public:
+    const char *format(int64_t, TimeFormat, int, size_t &);  // 格式化系统时间 (纳秒)，结果不以 '\0' 结尾
+};
+
+
 /*
 ***************************日志文件***************************
 */
 class CppLog {
 private:
     /* 私有成员变量 */
-    std::fstream m_fp = std::fstream();  // 日志文件
+    std::vector<char> m_buffer = std::vector<char>(1024 * 1024);  // 日志文件的写缓冲区 (1M)，先于 m_fp 构造、后于 m_fp 析构
+    std::vector<char> m_bin_buffer;  // 二进制日志文件的写缓冲区，第一条二进制日志到来时分配
+    std::fstream m_fp = std::fstream();  // 日志文件，日志类存活期间保持打开
+    std::fstream m_bin = std::fstream();  // 二进制日志文件 (与日志文件同目录、同名，扩展名为 .bin)，第一条二进制日志到来时打开
     std::string m_path;  // 日志文件路径
     std::string m_name = std::string("log.txt");  // 日志文件名称
     size_t m_max_size;  // 日志文件大小
+    size_t m_written = 0;  // 当前日志文件已写入的字节数，达到 m_max_size 时备份
+    size_t m_bin_written = 0;  // 当前二进制日志文件已写入的字节数
+    std::vector<bool> m_bin_defined;  // 各格式编号是否已写入当前二进制日志文件
     LogMode m_mode;  // 日志文件打开方式
     TimeFormat m_time_format;  // 时间格式
+    int m_time_precision = 0;  // 秒以下的位数，0 ~ 9，只对带时分秒的时间格式有效
     bool m_backup;  // 备份日志文件
     bool m_start = false;  // 判断日志类是否已经启动
     
-    std::mutex m_mutex;  // 日志文件互斥锁
-    std::queue<std::pair<std::string, int>> m_taskQ;  // 任务队列
+    uint64_t m_id = 0;  // 日志对象编号，写日志的线程据此找到自己在本对象中的缓冲区
+    std::mutex m_mutex;  // 保护 m_rings 与 m_start，日志线程在其上休眠
+    std::condition_variable m_condition;  // 有新日志或日志类停止时唤醒日志线程
+    std::atomic<bool> m_sleeping;  // 日志线程是否准备休眠，写日志的线程看到时才加锁唤醒
+    std::vector<std::shared_ptr<LogRing>> m_rings;  // 各写日志线程的缓冲区，线程首次写日志时登记
+    std::string m_line;  // 日志线程从缓冲区取出的一条日志
+
+    /* 时间缓存，只由日志线程访问 */
+    int64_t m_clock_offset = 0;  // 系统时间与 steady_clock 之差 (纳秒)，构造时测量，用于把写入时刻换算为系统时间
+    uint64_t m_tick_base = 0;  // 构造时的 logTick()
+    int64_t m_steady_base = 0;  // 构造时的 steady_clock 纳秒
+    uint64_t m_tick_ref = 0;  // 本批次开始时的 logTick()，换算的参考点
+    int64_t m_steady_ref = 0;  // 本批次开始时的 steady_clock 纳秒
+    double m_ns_per_tick = 1.0;  // 每个 tick 的纳秒数，由构造以来的间隔估计
+    TimeCache m_time_cache;  // 上一次的时间字符串
     std::thread* m_thread;  // 日志类线程
 
 private:
     bool backup();  // 备份日志文件
+    static std::string backupName(const std::string &);  // 备份文件名，同一秒内多次备份时追加序号
     bool open(std::string);  // 打开日志文件
     void close();  // 关闭日志文件
 
     std::string getCurrentTime();  // 获取当前时间
-    void write(const std::string);  // 不带时间
-    void writeWithTime(const std::string);  // 带时间
-
+    void calibrate();  // 更新 tick 与 steady_clock 的换算参考点
+    uint64_t toSteady(uint64_t);  // 写入时刻换算为 steady_clock 纳秒
+    const char *formatTime(uint64_t, size_t &);  // 获取日志写入时刻的时间，使用缓存
+    void write(const std::string &);  // 不带时间
+    void writeWithTime(const std::string &, uint64_t);  // 带时间
+    std::string binaryPath() const;  // 二进制日志文件路径
+    bool openBinary();  // 打开二进制日志文件
+    void writeBinary(const std::string &, uint64_t);  // 二进制日志
+
+    LogRing *localRing();  // 当前线程的缓冲区
+    void push(const char *, size_t, int);  // 写入当前线程的缓冲区
+    void wakeUp();  // 唤醒日志线程
+    bool pending();  // 是否有未写入的日志
     void working();  // 线程工作函数
 
 public:
@@ -77,10 +134,50 @@ public:
     /* 接口 */
     inline void setOpenMode(LogMode);  // 设置文件打开模式
     inline void setTimeFormat(TimeFormat);  // 设置时间格式
-    void addTask(std::string, int flag = 1);  // 向任务队列添加任务
+    inline void setTimePrecision(int);  // 设置秒以下的位数
+    void addTask(const std::string &, int flag = 1);  // 添加日志
+    void addTask(const char *, int flag = 1);  // 添加日志
+
+    /* 二进制日志 */
+    static size_t formatSecond(std::time_t, TimeFormat, char *);  // 格式化秒级时间戳，logdecode 也使用
+    static uint32_t registerFormat(const char *);  // 登记格式字符串，返回格式编号
+    static std::string formatOf(uint32_t);  // 格式编号对应的格式字符串
+    template<typename... Args>
+    void addBinary(uint32_t, const char *, const Args &...);  // 添加二进制日志，一般通过 CPPLOG_BINARY 调用
 };
 
 
+/*
+***************************二进制日志***************************
+*/
+// 用法: CPPLOG_BINARY(logger, "read %s: %d bytes in %.3f ms", path, n, ms);
+// 格式字符串在每个调用点只登记一次，之后每次调用只把格式编号、写入时刻与参数的原始字节写入线程缓冲区，
+// 日志线程原样写入二进制日志文件 (如 log.txt 对应 log.bin)，不做任何格式化；用 logdecode 转换为文本
+// 格式字符串作为 __VA_ARGS__ 的第一个参数，没有其余参数时也不依赖 ##__VA_ARGS__ 扩展
+#define CPPLOG_BINARY(logger, ...) \
+    do { \
+        static const uint32_t cpplog_format_id = CppLog::registerFormat(CPPLOG_FIRST_ARG(__VA_ARGS__)); \
+        (logger).addBinary(cpplog_format_id, __VA_ARGS__); \
+    } while (0)
+
+#define CPPLOG_FIRST_ARG(...) CPPLOG_FIRST_ARG_(__VA_ARGS__, 0)  // 取第一个参数，补一个参数使 ... 总不为空
+#define CPPLOG_FIRST_ARG_(first, ...) first
+
+
+/**
+ * @description: 添加二进制日志
+ * @param {uint32_t} id: registerFormat 返回的格式编号
+ * @param {const char *}: 格式字符串，已由编号代表，不写入
+ * @param {Args} ...args: 参数，支持整数、浮点数、枚举、char、C 字符串与 std::string
+ */
+template<typename... Args>
+inline void CppLog::addBinary(uint32_t id, const char *, const Args &... args) {
+    char buffer[log_binary::MAX_RECORD];
+    size_t length = log_binary::encode(buffer, id, args...);
+    this->push(buffer, length, LogRing::BINARY);
+}
+
+
 /** 
  * @description: 设置文件打开模式
  * @param {LogMode} mode: 文件打开模式
@@ -98,4 +195,13 @@ inline void CppLog::setTimeFormat(TimeFormat ft) {
     this->m_time_format = ft;
 }
 
+
+/**
+ * @description: 设置秒以下的位数，如 3 为毫秒、6 为微秒，默认 0；YMDA 与 YMDB 格式没有时分秒，不受影响
+ * @param {int} precision: 位数，0 ~ 9
+ */
+inline void CppLog::setTimePrecision(int precision) {
+    this->m_time_precision = precision < 0 ? 0 : (precision > 9 ? 9 : precision);
+}
+
 #endif  // !CppLog_H_
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 02:16:40
+ * @last_edit_time: 2026-10-18 02:16:40
+ * @file_path: /Tiny-Cpp-Frame/CppLog/include/LogBinary.h
+ * @description: 二进制日志头文件: 参数编码与二进制日志文件格式，由 CppLog 与 logdecode 共用
+ */
+
+
+#ifndef LogBinary_H_
+#define LogBinary_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/*
+***************************二进制日志文件格式***************************
+*/
+// 文件由记录组成，每条记录以 1 字节的类型开头，整数均为本机字节序:
+//   'H' 会话头: 8 字节 MAGIC，int64 系统时间与 steady_clock 之差 (纳秒)；每次打开文件时写入，之后的格式编号只在本会话内有效
+//   'F' 格式字符串: uint32 编号，uint32 长度，内容；某个编号在会话中第一次使用前写入
+//   'R' 日志: uint64 写入时刻 (steady_clock 纳秒)，uint32 长度，内容 (见下方日志内容)
+// 日志内容: uint32 格式编号，uint8 参数个数，每个参数为 1 字节类型加取值；字符串为 uint16 长度加内容
+namespace log_binary {
+
+    static const char MAGIC[8] = { 'C', 'P', 'P', 'L', 'O', 'G', 'B', '1' };
+    static const size_t MAX_RECORD = 1024;  // 单条日志内容的最大字节数，字符串参数超出部分截断
+
+    enum RecordKind : uint8_t {
+        SESSION = 'H',
+        FORMAT = 'F',
+        RECORD = 'R'
+    };
+
+    enum ArgType : uint8_t {
+        INT32 = 1,
+        UINT32,
+        INT64,
+        UINT64,
+        FLOAT64,
+        CHAR,
+        STRING
+    };
+
+
+    /*
+    ***************************参数编码***************************
+    */
+
+    // 写入位置，空间不足的参数不写入，参数个数只计已写入的
+    struct Writer {
+        char *p;
+        char *end;
+        uint8_t count;  // 已写入的参数个数
+    };
+
+    template<typename T>
+    inline void putValue(Writer &w, ArgType type, T value) {
+        if ((size_t)(w.end - w.p) < 1 + sizeof(T)) {
+            return;
+        }
+        *w.p++ = (char)type;
+        std::memcpy(w.p, &value, sizeof(T));
+        w.p += sizeof(T);
+        ++w.count;
+    }
+
+    inline void putString(Writer &w, const char *str, size_t length) {
+        size_t room = (size_t)(w.end - w.p);
+        if (room < 3) {
+            return;
+        }
+        if (length > room - 3) {
+            length = room - 3;
+        }
+        if (length > 0xFFFF) {
+            length = 0xFFFF;
+        }
+        uint16_t n = (uint16_t)length;
+        *w.p++ = (char)STRING;
+        std::memcpy(w.p, &n, 2);
+        std::memcpy(w.p + 2, str, n);
+        w.p += 2 + n;
+        ++w.count;
+    }
+
+    inline void put(Writer &w, char value) { putValue(w, CHAR, value); }
+    inline void put(Writer &w, const char *value) { putString(w, value, std::strlen(value)); }
+    inline void put(Writer &w, const std::string &value) { putString(w, value.data(), value.size()); }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_floating_point<T>::value>::type put(Writer &w, T value) {
+        putValue(w, FLOAT64, (double)value);
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type put(Writer &w, T value) {
+        if (sizeof(T) <= 4)
+            putValue(w, INT32, (int32_t)value);
+        else
+            putValue(w, INT64, (int64_t)value);
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type put(Writer &w, T value) {
+        if (sizeof(T) <= 4)
+            putValue(w, UINT32, (uint32_t)value);
+        else
+            putValue(w, UINT64, (uint64_t)value);
+    }
+
+    template<typename T>
+    inline typename std::enable_if<std::is_enum<T>::value>::type put(Writer &w, T value) {
+        put(w, (typename std::underlying_type<T>::type)value);
+    }
+
+
+    /**
+     * @description: 编码一条日志的内容
+     * @param {char *} buffer: 输出，至少 MAX_RECORD 字节
+     * @param {uint32_t} id: 格式编号
+     * @param {Args} ...args: 参数，支持整数、浮点数、枚举、char、C 字符串与 std::string
+     * @return {size_t} 字节数
+     */
+    template<typename... Args>
+    inline size_t encode(char *buffer, uint32_t id, const Args &... args) {
+        std::memcpy(buffer, &id, 4);
+        Writer w = { buffer + 5, buffer + MAX_RECORD, 0 };
+        int expand[] = { 0, (put(w, args), 0)... };
+        (void)expand;
+        buffer[4] = (char)w.count;
+        return (size_t)(w.p - buffer);
+    }
+
+}  // namespace log_binary
+
+#endif  // !LogBinary_H_
@@ -0,0 +1,296 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 04:10:37
+ * @last_edit_time: 2026-10-18 04:10:37
+ * @file_path: /Tiny-Cpp-Frame/CppLog/include/LogDecode.h
+ * @description: 二进制日志解码头文件: 参数解码、按格式字符串还原日志文本与逐条读取二进制日志文件，由 logdecode 与测试共用
+ */
+
+
+#ifndef LogDecode_H_
+#define LogDecode_H_
+
+#include "LogBinary.h"
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace log_binary {
+
+    /*
+    ***************************参数解码***************************
+    */
+
+    // 一个已解码的参数
+    struct Arg {
+        uint8_t type;
+        int64_t i;
+        uint64_t u;
+        double d;
+        std::string s;
+    };
+
+
+    /**
+     * @description: 解码日志内容中的参数
+     * @param {const char *} p: 参数开头
+     * @param {const char *} end: 日志内容末尾
+     * @param {size_t} count: 参数个数
+     * @param {vector<Arg>} &args: 输出
+     * @return {bool} 内容完整返回 true
+     */
+    inline bool decodeArgs(const char *p, const char *end, size_t count, std::vector<Arg> &args) {
+        args.resize(count);
+        for (size_t k = 0; k < count; ++k) {
+            if (p >= end) {
+                return false;
+            }
+            Arg &arg = args[k];
+            arg.type = (uint8_t)*p++;
+            size_t size = 0;
+            switch (arg.type) {
+                case INT32: case UINT32: size = 4; break;
+                case INT64: case UINT64: case FLOAT64: size = 8; break;
+                case CHAR: size = 1; break;
+                case STRING: size = 2; break;
+                default: return false;
+            }
+            if ((size_t)(end - p) < size) {
+                return false;
+            }
+
+            if (arg.type == INT32) {
+                int32_t v;
+                std::memcpy(&v, p, 4);
+                arg.i = v;
+                arg.u = (uint64_t)(int64_t)v;
+                arg.d = v;
+            }
+            else if (arg.type == UINT32) {
+                uint32_t v;
+                std::memcpy(&v, p, 4);
+                arg.i = v;
+                arg.u = v;
+                arg.d = v;
+            }
+            else if (arg.type == INT64) {
+                std::memcpy(&arg.i, p, 8);
+                arg.u = (uint64_t)arg.i;
+                arg.d = (double)arg.i;
+            }
+            else if (arg.type == UINT64) {
+                std::memcpy(&arg.u, p, 8);
+                arg.i = (int64_t)arg.u;
+                arg.d = (double)arg.u;
+            }
+            else if (arg.type == FLOAT64) {
+                std::memcpy(&arg.d, p, 8);
+                arg.i = (int64_t)arg.d;
+                arg.u = (uint64_t)arg.i;
+            }
+            else if (arg.type == CHAR) {
+                arg.i = (unsigned char)*p;
+                arg.u = (uint64_t)arg.i;
+                arg.d = (double)arg.i;
+            }
+            else {
+                uint16_t n;
+                std::memcpy(&n, p, 2);
+                if ((size_t)(end - p - 2) < n) {
+                    return false;
+                }
+                arg.s.assign(p + 2, n);
+            }
+            p += size;
+            if (arg.type == STRING) {
+                p += arg.s.size();
+            }
+        }
+        return true;
+    }
+
+
+    /**
+     * @description: 按一个转换说明格式化一个参数，长度修饰符按参数的实际类型重写
+     * @param {string} &out: 输出
+     * @param {string} spec: 去掉长度修饰符与转换字符的说明，如 "%-8.3"
+     * @param {char} conversion: 转换字符
+     * @param {Arg} &arg: 参数
+     */
+    inline void formatArg(std::string &out, std::string spec, char conversion, const Arg &arg) {
+        char buffer[512];
+        int n;
+        if (arg.type == STRING) {
+            if (conversion == 's') {
+                n = snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), arg.s.c_str());
+            }
+            else {  // 类型不符，原样输出
+                out += arg.s;
+                return;
+            }
+        }
+        else if (conversion == 'd' || conversion == 'i') {
+            n = snprintf(buffer, sizeof(buffer), (spec + "lld").c_str(), (long long)arg.i);
+        }
+        else if (conversion == 'u' || conversion == 'x' || conversion == 'X' || conversion == 'o') {
+            n = snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), (unsigned long long)arg.u);
+        }
+        else if (std::strchr("fFeEgGaA", conversion) != nullptr) {
+            n = snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), arg.d);
+        }
+        else if (conversion == 'c') {
+            n = snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), (int)arg.i);
+        }
+        else if (conversion == 'p') {
+            n = snprintf(buffer, sizeof(buffer), (spec + "llx").c_str(), (unsigned long long)arg.u);
+        }
+        else {  // %s 等对应数值参数
+            n = arg.type == FLOAT64 ? snprintf(buffer, sizeof(buffer), "%g", arg.d)
+                : arg.type == INT32 || arg.type == INT64 ? snprintf(buffer, sizeof(buffer), "%lld", (long long)arg.i)
+                : snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)arg.u);
+        }
+
+        if (n > 0) {
+            out.append(buffer, (size_t)n < sizeof(buffer) ? (size_t)n : sizeof(buffer) - 1);
+        }
+    }
+
+
+    /**
+     * @description: 按 printf 风格的格式字符串拼接日志文本；缺少的参数输出为 <?>
+     * @param {string} &format: 格式字符串
+     * @param {vector<Arg>} &args: 参数
+     * @return {std::string} 日志文本
+     */
+    inline std::string formatMessage(const std::string &format, const std::vector<Arg> &args) {
+        std::string out;
+        size_t next = 0;
+        for (size_t i = 0; i < format.size(); ++i) {
+            if (format[i] != '%') {
+                out += format[i];
+                continue;
+            }
+            if (i + 1 < format.size() && format[i + 1] == '%') {
+                out += '%';
+                ++i;
+                continue;
+            }
+
+            /* 标志、宽度与精度保留，长度修饰符丢弃 */
+            std::string spec("%");
+            size_t j = i + 1;
+            while (j < format.size() && std::strchr("-+ #0123456789.", format[j]) != nullptr) {
+                spec += format[j++];
+            }
+            while (j < format.size() && std::strchr("hlLqjzt", format[j]) != nullptr) {
+                ++j;
+            }
+            if (j >= format.size()) {
+                out += format.substr(i);
+                break;
+            }
+
+            if (next < args.size()) {
+                formatArg(out, spec, format[j], args[next++]);
+            }
+            else {
+                out += "<?>";
+            }
+            i = j;
+        }
+        return out;
+    }
+
+
+    /*
+    ***************************文件读取***************************
+    */
+
+    // 一条已解码的日志
+    struct Entry {
+        int64_t wall;  // 写入时刻的系统时间 (纳秒)
+        std::string message;  // 日志文本
+        bool complete;  // 参数是否完整
+    };
+
+    // 逐条读取二进制日志文件，处理会话头与格式字符串
+    class Reader {
+    public:
+        enum Result {
+            ENTRY,  // 读到一条日志
+            END,  // 文件结束 (末尾不完整的记录视为结束)
+            CORRUPT  // 不是二进制日志文件或已损坏
+        };
+
+        explicit Reader(std::istream &in) : m_in(in) { }
+
+        /**
+         * @description: 读取下一条日志
+         * @param {Entry} &entry: 输出
+         * @return {Result} 读取结果
+         */
+        Result next(Entry &entry) {
+            char kind;
+            while (this->m_in.get(kind)) {
+                if (kind == (char)SESSION) {
+                    char magic[sizeof(MAGIC)];
+                    if (!this->m_in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(magic)) != 0 || !this->m_in.read((char*)&this->m_offset, 8)) {
+                        return END;
+                    }
+                    this->m_formats.clear();
+                    this->m_session = true;
+                }
+                else if (kind == (char)FORMAT && this->m_session) {
+                    uint32_t id, length;
+                    if (!this->m_in.read((char*)&id, 4) || !this->m_in.read((char*)&length, 4)) {
+                        return END;
+                    }
+                    if (id >= this->m_formats.size()) {
+                        this->m_formats.resize(id + 1);
+                    }
+                    this->m_formats[id].resize(length);
+                    if (length > 0 && !this->m_in.read(&this->m_formats[id][0], length)) {
+                        return END;
+                    }
+                }
+                else if (kind == (char)RECORD && this->m_session) {
+                    uint64_t stamp;
+                    uint32_t length;
+                    if (!this->m_in.read((char*)&stamp, 8) || !this->m_in.read((char*)&length, 4) || length < 5) {
+                        return END;
+                    }
+                    this->m_record.resize(length);
+                    if (!this->m_in.read(&this->m_record[0], length)) {
+                        return END;
+                    }
+
+                    uint32_t id;
+                    std::memcpy(&id, this->m_record.data(), 4);
+                    entry.complete = decodeArgs(this->m_record.data() + 5, this->m_record.data() + length, (uint8_t)this->m_record[4], this->m_args);
+                    entry.message = formatMessage(id < this->m_formats.size() ? this->m_formats[id] : std::string("<未知格式>"), this->m_args);
+                    entry.wall = (int64_t)stamp + this->m_offset;
+                    return ENTRY;
+                }
+                else {
+                    return CORRUPT;
+                }
+            }
+            return END;
+        }
+
+    private:
+        std::istream &m_in;
+        std::vector<std::string> m_formats;  // 当前会话的格式字符串，下标为格式编号
+        std::vector<Arg> m_args;
+        std::string m_record;
+        int64_t m_offset = 0;  // 当前会话的系统时间与 steady_clock 之差
+        bool m_session = false;
+    };
+
+}  // namespace log_binary
+
+#endif  // !LogDecode_H_
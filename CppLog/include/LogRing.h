@@ -0,0 +1,165 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 01:05:12
+ * @last_edit_time: 2026-10-18 01:05:12
+ * @file_path: /Tiny-Cpp-Frame/CppLog/include/LogRing.h
+ * @description: 日志缓冲区头文件: 单生产者单消费者的无锁环形缓冲区，每个写日志的线程一个
+ */
+
+
+#ifndef LogRing_H_
+#define LogRing_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define LOG_TICK_TSC 1  // 平台可以读取 TSC，是否使用由 logTickIsTsc() 在运行时决定
+#endif
+
+/**
+ * @description: 写入时刻是否使用 TSC；只有 CPU 声明不变 TSC (cpuid 0x80000007 EDX 第 8 位: 频率恒定、节能状态下不停止) 时才使用，
+ *               否则 TSC 可能随频率变化或在各核心间不同步，改用 steady_clock；只检测一次
+ * @return {bool} true/false
+ */
+inline bool logTickIsTsc() {
+#ifdef LOG_TICK_TSC
+    static const bool invariant = []() {
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0 && (edx & (1u << 8)) != 0;
+    }();
+    return invariant;
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @description: 写日志的线程记录写入时刻；不变 TSC 可用时读取 TSC (比 steady_clock::now 快)，否则为 steady_clock 纳秒，
+ *               由日志线程换算为 steady_clock 纳秒 (CppLog::toSteady)
+ * @return {uint64_t} 写入时刻
+ */
+inline uint64_t logTick() {
+#ifdef LOG_TICK_TSC
+    if (logTickIsTsc()) {
+        return __rdtsc();
+    }
+#endif
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/*
+***************************日志缓冲区***************************
+*/
+// 生产者为写日志的线程，消费者为日志线程；记录为 [Header][内容]，按字节连续存放，到末尾时折回开头
+// 读写位置只增不减，取模得到下标；生产者只写 m_head，消费者只写 m_tail
+class LogRing {
+public:
+    static const size_t CACHE_LINE = 64;
+    static const size_t CAPACITY = 256 * 1024;  // 缓冲区大小，必须是 2 的幂
+
+    // 记录头
+    struct Header {
+        uint64_t stamp;  // 写入时刻 (logTick())，日志线程按它合并各线程的记录
+        uint32_t length;  // 内容的字节数
+        int32_t flag;  // 是否记录时间，同 CppLog::addTask；为 BINARY 时内容为二进制日志
+    };
+
+    static const int32_t BINARY = -1;  // 二进制日志的 flag，addTask 的 flag 只取 0 或 1
+
+    static const size_t MAX_MESSAGE = CAPACITY / 2 - sizeof(Header);  // 单条日志的最大字节数，超出部分截断
+
+    LogRing() : m_cached_tail(0), m_data(new char[CAPACITY]) {
+        this->m_head.store(0, std::memory_order_relaxed);
+        this->m_tail.store(0, std::memory_order_relaxed);
+        this->m_producer_gone.store(false, std::memory_order_relaxed);
+        this->m_consumer_gone.store(false, std::memory_order_relaxed);
+    }
+    LogRing(const LogRing &) = delete;
+    LogRing &operator=(const LogRing &) = delete;
+
+    /* 生产者 */
+
+    /**
+     * @description: 写入一条记录
+     * @param {uint64_t} stamp: 写入时刻
+     * @param {int} flag: 是否记录时间
+     * @param {const char *} str: 内容
+     * @param {size_t} length: 内容的字节数，不超过 MAX_MESSAGE
+     * @return {bool} 缓冲区空间不足时返回 false
+     */
+    bool tryPush(uint64_t stamp, int flag, const char *str, size_t length) {
+        uint64_t head = this->m_head.load(std::memory_order_relaxed);
+        size_t need = sizeof(Header) + length;
+        if (head + need - this->m_cached_tail > CAPACITY) {
+            this->m_cached_tail = this->m_tail.load(std::memory_order_acquire);  // 缓存的读位置已过时，重新读取
+            if (head + need - this->m_cached_tail > CAPACITY) {
+                return false;
+            }
+        }
+
+        Header header = { stamp, (uint32_t)length, (int32_t)flag };
+        this->copyIn(head, &header, sizeof(Header));
+        this->copyIn(head + sizeof(Header), str, length);
+        this->m_head.store(head + need, std::memory_order_release);
+        return true;
+    }
+
+    void closeProducer() { this->m_producer_gone.store(true, std::memory_order_release); }  // 写日志的线程退出
+    bool consumerClosed() const { return this->m_consumer_gone.load(std::memory_order_acquire); }
+
+    /* 消费者 */
+
+    uint64_t head() const { return this->m_head.load(std::memory_order_acquire); }  // 已写入的末尾
+    uint64_t tail() const { return this->m_tail.load(std::memory_order_relaxed); }  // 未读取的开头
+    bool empty() const { return this->head() == this->tail(); }
+
+    /**
+     * @description: 从指定位置读取
+     * @param {uint64_t} pos: 读取位置，位于 [tail(), head()) 中
+     * @param {void *} dst: 目标地址
+     * @param {size_t} n: 字节数
+     */
+    void read(uint64_t pos, void *dst, size_t n) const {
+        size_t offset = (size_t)(pos & (CAPACITY - 1));
+        size_t first = n < CAPACITY - offset ? n : CAPACITY - offset;
+        std::memcpy(dst, this->m_data.get() + offset, first);
+        if (first < n) {  // 折回开头
+            std::memcpy((char*)dst + first, this->m_data.get(), n - first);
+        }
+    }
+
+    void consume(uint64_t tail) { this->m_tail.store(tail, std::memory_order_release); }  // 释放 tail 之前的空间
+    void closeConsumer() { this->m_consumer_gone.store(true, std::memory_order_release); }  // 日志类析构
+    bool producerClosed() const { return this->m_producer_gone.load(std::memory_order_acquire); }
+
+private:
+    char m_pad_front[CACHE_LINE];  // 与前面的数据隔开
+    std::atomic<uint64_t> m_head;  // 写位置
+    uint64_t m_cached_tail;  // 生产者缓存的读位置，空间不足时才重新读取 m_tail
+    std::unique_ptr<char[]> m_data;  // 构造后不再改变，与写位置放在一起
+    char m_pad_middle[CACHE_LINE];  // 读写位置不共享缓存行
+    std::atomic<uint64_t> m_tail;  // 读位置
+    std::atomic<bool> m_producer_gone;
+    std::atomic<bool> m_consumer_gone;
+    char m_pad_back[CACHE_LINE];  // 与后面的数据隔开
+
+    void copyIn(uint64_t pos, const void *src, size_t n) {
+        size_t offset = (size_t)(pos & (CAPACITY - 1));
+        size_t first = n < CAPACITY - offset ? n : CAPACITY - offset;
+        std::memcpy(this->m_data.get() + offset, src, first);
+        if (first < n) {  // 折回开头
+            std::memcpy(this->m_data.get(), (const char*)src + first, n - first);
+        }
+    }
+};
+
+#endif  // !LogRing_H_
@@ -11,8 +11,23 @@
 #include "CppLog.h"
 #include <string>
 #include <chrono>
+#include <cstring>
 #include <sys/stat.h>
 
+static std::atomic<uint64_t> next_logger_id(1);  // 日志对象编号，从 1 开始
+static const std::chrono::milliseconds LINGER(1);  // 日志线程写完一批后先等待的时间，期间写日志的线程不需要唤醒它
+
+// 二进制日志的格式字符串表，所有日志对象共用；函数内静态变量，静态初始化期间也可以登记
+struct FormatTable {
+    std::mutex mutex;
+    std::vector<std::string> formats;  // 下标为格式编号
+};
+
+static FormatTable &formatTable() {
+    static FormatTable table;
+    return table;
+}
+
 /**
  * @description: 日志模块对象初始化函数
  * @param {size_t} max_size: 日志文件的大小，超过该大小则切换另一个文件，默认为 50M
@@ -27,28 +42,50 @@ CppLog::CppLog(const size_t max_log_size, const std::string log_path, const LogM
     , m_time_format(tf)
     , m_backup(backup) 
 { 
+    this->m_id = next_logger_id.fetch_add(1);
+    this->m_steady_base = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    this->m_tick_base = logTick();
+    this->m_clock_offset = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - this->m_steady_base;
+    this->calibrate();
+    this->m_sleeping.store(false);
     m_start = true;
     m_thread = new std::thread(&CppLog::working, this);  // 构造线程
 }
 
 
 /**
- * @description: CppLog 对象析构函数，会调用成员函数 close()
+ * @description: CppLog 对象析构函数，通知日志线程写完剩余任务后退出，然后调用成员函数 close()
  */
 CppLog::~CppLog() {
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_start = false;
+    }
+    this->m_condition.notify_one();
+
+    if (this->m_thread->joinable()) {
+        this->m_thread->join();
+    }
+    delete this->m_thread;
+
+    if (this->m_bin.is_open()) {
+        this->m_bin.close();
+    }
+
+    for (const std::shared_ptr<LogRing> &ring : this->m_rings) {  // 通知写日志的线程释放缓冲区
+        ring->closeConsumer();
+    }
+
     this->close();
 }
 
 
 /**
- * @description: 关闭日志文件
+ * @description: 关闭日志文件 (写出缓冲区中的内容)，不改变文件名、打开方式与时间格式
  */
 void CppLog::close() {
-    if (this->m_fp) {
+    if (this->m_fp.is_open()) {
         this->m_fp.close();
-        this->m_name = std::string("log.txt");
-        this->m_mode = LogMode::ADDTO;
-        m_time_format = TimeFormat::FULLA;
     }
 }
 
@@ -65,6 +102,7 @@ bool CppLog::open(std::string name) {
     /* 打开日志文件 */
     this->m_name = name;
     std::string full_path = this->m_path + "/" + name;
+    this->m_fp.rdbuf()->pubsetbuf(this->m_buffer.data(), this->m_buffer.size());  // 须在打开前设置
 
     if (this->m_mode == LogMode::ADDTO) {
         this->m_fp.open(full_path, std::ofstream::app);
@@ -76,6 +114,15 @@ bool CppLog::open(std::string name) {
     if (!this->m_fp) {  // 打开失败
         return false;
     }
+
+    /* 已有的文件大小，之后由写入的字节数累加，不再查询文件属性 */
+    this->m_written = 0;
+    if (this->m_mode == LogMode::ADDTO) {
+        struct stat stat_buf;  // 存储文件(夹)信息的结构体，有文件大小和创建时间、访问时间、修改时间等
+        if (stat(full_path.c_str(), &stat_buf) == 0) {
+            this->m_written = stat_buf.st_size;
+        }
+    }
     return true;
 }
 
@@ -90,23 +137,12 @@ bool CppLog::backup() {
         return false;
     }
 
-    /* 获取文件大小 */
-	struct stat stat_buf;  // 存储文件(夹)信息的结构体，有文件大小和创建时间、访问时间、修改时间等
-    std::string full_path = this->m_path + "/" + this->m_name; 
-	stat(full_path.c_str(), &stat_buf);  // 提供文件名字符串，获得文件属性结构体
-	size_t file_size = stat_buf.st_size;  // 获取文件大小
-
-    /* 备份文件 */
-    if (file_size >= this->m_max_size * 1024 * 1024) {
-        /* 配置时间 */
-        TimeFormat ft = this->m_time_format;
-        this->setTimeFormat(TimeFormat::FULLA);
-        std::string now_t = this->getCurrentTime();
-        this->setTimeFormat(ft);
-
+    /* 备份文件，文件大小由已写入的字节数得到 */
+    std::string full_path = this->m_path + "/" + this->m_name;
+    if (this->m_written >= this->m_max_size * 1024 * 1024) {
         /* 重命名 */
         this->m_fp.close();
-        std::string new_name = full_path + " " + now_t;
+        std::string new_name = backupName(full_path);
         rename(full_path.c_str(), new_name.c_str());
     }
     else return false;
@@ -116,38 +152,55 @@ bool CppLog::backup() {
 
 
 /**
- * @description: 获取指定时间格式的当前时间字符串
- * @return {std::string}: 指定时间格式的字符串
+ * @description: 备份文件名为 "<文件> YYYY-MM-DD HH:MM:SS"；该文件已存在 (同一秒内多次备份) 时追加 " (n)"，
+ *               避免 rename 覆盖之前的备份
+ * @param {string} &full_path: 日志文件路径
+ * @return {std::string}: 尚不存在的备份文件路径
  */
-std::string CppLog::getCurrentTime() {
-    /* 获取当前时间戳 */
-    std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-    std::time_t now_t = std::chrono::system_clock::to_time_t(now);
+std::string CppLog::backupName(const std::string &full_path) {
+    char now_t[20];
+    size_t length = formatSecond(std::time(nullptr), TimeFormat::FULLA, now_t);
+    std::string base = full_path + " " + std::string(now_t, length);
 
-    /* 将当前时间戳转换为 string */
-    struct tm now_st = *localtime (&now_t);
+    std::string name = base;
+    struct stat stat_buf;
+    for (int n = 1; stat(name.c_str(), &stat_buf) == 0; ++n) {
+        name = base + " (" + std::to_string(n) + ")";
+    }
+    return name;
+}
+
+
+/**
+ * @description: 将秒级时间戳格式化为指定时间格式的字符串
+ * @param {time_t} t: 秒级时间戳
+ * @param {TimeFormat} tf: 时间格式
+ * @param {char *} ctime: 输出，至少 20 字节
+ * @return {size_t}: 字符串长度
+ */
+size_t CppLog::formatSecond(std::time_t t, TimeFormat tf, char *ctime) {
+    struct tm now_st;
+    localtime_r(&t, &now_st);  // 不使用 localtime 的共享缓冲区
     now_st.tm_year = now_st.tm_year + 1900;
     ++now_st.tm_mon;
-    char ctime[20];
 
-   
-    if (this->m_time_format == TimeFormat::FULLB) {
+    if (tf == TimeFormat::FULLB) {
         snprintf(ctime, 20, "%04d/%02d/%02d %02d:%02d:%02d"
             , now_st.tm_year, now_st.tm_mon, now_st.tm_mday
             , now_st.tm_hour, now_st.tm_min, now_st.tm_sec
         );
     }
-    else if (this->m_time_format == TimeFormat::YMDA) {
+    else if (tf == TimeFormat::YMDA) {
         snprintf(ctime, 11, "%04d-%02d-%02d"
             , now_st.tm_year, now_st.tm_mon, now_st.tm_mday
         );
     }
-    else if (this->m_time_format == TimeFormat::YMDB) {
+    else if (tf == TimeFormat::YMDB) {
         snprintf(ctime, 11, "%04d/%02d/%02d"
             , now_st.tm_year, now_st.tm_mon, now_st.tm_mday
         );
     }
-    else if (this->m_time_format == TimeFormat::TIMEONLY) {
+    else if (tf == TimeFormat::TIMEONLY) {
         snprintf(ctime, 9, "%02d:%02d:%02d"
             , now_st.tm_hour, now_st.tm_min, now_st.tm_sec
         );
@@ -159,63 +212,503 @@ std::string CppLog::getCurrentTime() {
         );
     }
 
-    return std::string(ctime);
+    return strlen(ctime);
+}
+
+
+/**
+ * @description: 获取指定时间格式的当前时间字符串
+ * @return {std::string}: 指定时间格式的字符串
+ */
+std::string CppLog::getCurrentTime() {
+    /* 获取当前时间戳 */
+    std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+    std::time_t now_t = std::chrono::system_clock::to_time_t(now);
+
+    /* 将当前时间戳转换为 string */
+    char ctime[20];
+    size_t length = formatSecond(now_t, this->m_time_format, ctime);
+    return std::string(ctime, length);
+}
+
+
+/**
+ * @description: 更新 tick 与 steady_clock 的换算参考点，每批次开始时调用；比例由构造以来的间隔估计，
+ *               换算误差与记录距参考点的时间成正比，一批日志的时间跨度很短
+ */
+void CppLog::calibrate() {
+    if (!logTickIsTsc()) {
+        return;  // 写入时刻已是 steady_clock 纳秒
+    }
+
+    this->m_steady_ref = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    this->m_tick_ref = logTick();
+    if (this->m_tick_ref > this->m_tick_base && this->m_steady_ref > this->m_steady_base) {
+        this->m_ns_per_tick = (double)(this->m_steady_ref - this->m_steady_base) / (double)(this->m_tick_ref - this->m_tick_base);
+    }
+}
+
+
+/**
+ * @description: 写入时刻换算为 steady_clock 纳秒
+ * @param {uint64_t} tick: 写入时刻 (logTick())
+ * @return {uint64_t}: steady_clock 纳秒
+ */
+uint64_t CppLog::toSteady(uint64_t tick) {
+    if (!logTickIsTsc()) {
+        return tick;
+    }
+    return (uint64_t)(this->m_steady_ref + (int64_t)((double)(int64_t)(tick - this->m_tick_ref) * this->m_ns_per_tick));
+}
+
+
+/**
+ * @description: 获取日志写入时刻的时间字符串，结果缓存到下一次调用
+ * @param {uint64_t} stamp: 写入时刻 (steady_clock 纳秒)，由写日志的线程记录
+ * @param {size_t} &length: 输出，字符串长度
+ * @return {const char *}: 时间字符串，不以 '\0' 结尾
+ */
+const char *CppLog::formatTime(uint64_t stamp, size_t &length) {
+    int64_t wall = (int64_t)stamp + this->m_clock_offset;  // 系统时间 (纳秒)
+    return this->m_time_cache.format(wall, this->m_time_format, this->m_time_precision, length);
+}
+
+
+/**
+ * @description: 格式化系统时间；同一秒内只改写秒以下的数字，同一分钟内只改写秒的两位数字，其余情况才重新格式化
+ * @param {int64_t} wall: 系统时间 (纳秒)
+ * @param {TimeFormat} tf: 时间格式
+ * @param {int} precision: 秒以下的位数，0 ~ 9，只对带时分秒的时间格式有效
+ * @param {size_t} &length: 输出，字符串长度
+ * @return {const char *}: 时间字符串，不以 '\0' 结尾，下一次调用前有效
+ */
+const char *TimeCache::format(int64_t wall, TimeFormat tf, int precision, size_t &length) {
+    int64_t second = wall / 1000000000;
+    int64_t fraction = wall % 1000000000;
+
+    /* 时间格式或精度改变，缓存失效 */
+    if (this->m_format != tf || this->m_precision != precision) {
+        this->m_format = tf;
+        this->m_precision = precision;
+        this->m_second = -1;
+    }
+
+    if (second != this->m_second) {
+        bool has_time = this->m_format != TimeFormat::YMDA && this->m_format != TimeFormat::YMDB;
+        if (this->m_second >= 0 && second / 60 == this->m_second / 60) {  // 同一分钟
+            if (has_time) {
+                int sec = (int)(second % 60);
+                this->m_text[this->m_sec_pos] = (char)('0' + sec / 10);
+                this->m_text[this->m_sec_pos + 1] = (char)('0' + sec % 10);
+            }
+        }
+        else {
+            this->m_length = CppLog::formatSecond((std::time_t)second, this->m_format, this->m_text);
+            this->m_sec_pos = this->m_length - 2;
+            if (has_time && this->m_precision > 0) {
+                this->m_text[this->m_length] = '.';
+                this->m_length += 1 + this->m_precision;
+            }
+        }
+        this->m_second = second;
+    }
+
+    /* 秒以下的数字 */
+    if (this->m_length > this->m_sec_pos + 2) {
+        for (int i = 9; i > this->m_precision; --i) {
+            fraction /= 10;
+        }
+        for (size_t i = this->m_length; i > this->m_sec_pos + 3; --i) {
+            this->m_text[i - 1] = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+    }
+
+    length = this->m_length;
+    return this->m_text;
 }
 
 
 /**
  * @description: 带时间写入日志
  * @param {string} str: 写入日志的内容
+ * @param {uint64_t} stamp: 写入时刻 (steady_clock 纳秒)
  */
-void CppLog::writeWithTime(const std::string str) {
-    this->open(this->m_name);
+void CppLog::writeWithTime(const std::string &str, uint64_t stamp) {
+    static const char spaces[] = "                    ";  // 时间不足 20 个字符时补齐
     this->backup();
-    std::string now_t = this->getCurrentTime();
-    while (now_t.length() != 20) now_t += " ";
-    this->m_fp << now_t << " --->  " << str << '\n';
+    size_t length;
+    const char *now_t = this->formatTime(stamp, length);
+    size_t pad = length < 20 ? 20 - length : 0;
+
+    this->m_fp.write(now_t, length);
+    this->m_fp.write(spaces, pad);
+    this->m_fp.write(" --->  ", 7);
+    this->m_fp.write(str.data(), str.size());
+    this->m_fp.put('\n');
+    this->m_written += length + pad + 7 + str.size() + 1;
+}
+
+/**
+ * @description: 二进制日志文件路径，与日志文件同目录，扩展名换为 .bin (log.txt 对应 log.bin，没有扩展名时追加)
+ * @return {std::string}: 路径
+ */
+std::string CppLog::binaryPath() const {
+    std::string name = this->m_name;
+    size_t dot = name.rfind('.');
+    if (dot != std::string::npos && dot != 0) {
+        name.erase(dot);
+    }
+    return this->m_path + "/" + name + ".bin";
+}
+
+
+/**
+ * @description: 打开二进制日志文件并写入会话头，打开方式同日志文件；之后格式字符串重新写入
+ * @return {bool}: 打开成功返回 true， 失败返回 false
+ */
+bool CppLog::openBinary() {
+    std::string full_path = this->binaryPath();
+    if (this->m_bin_buffer.empty()) {
+        this->m_bin_buffer.resize(1024 * 1024);
+    }
+    this->m_bin.rdbuf()->pubsetbuf(this->m_bin_buffer.data(), this->m_bin_buffer.size());  // 须在打开前设置
+
+    if (this->m_mode == LogMode::ADDTO) {
+        this->m_bin.open(full_path, std::ofstream::app | std::ofstream::binary);
+    }
+    else if (this->m_mode == LogMode::WRITEONLY) {
+        this->m_bin.open(full_path, std::ofstream::out | std::ofstream::binary);
+    }
+
+    if (!this->m_bin) {  // 打开失败
+        return false;
+    }
+
+    this->m_bin_written = 0;
+    if (this->m_mode == LogMode::ADDTO) {
+        struct stat stat_buf;
+        if (stat(full_path.c_str(), &stat_buf) == 0) {
+            this->m_bin_written = stat_buf.st_size;
+        }
+    }
+
+    /* 会话头 */
+    char kind = (char)log_binary::SESSION;
+    this->m_bin.write(&kind, 1);
+    this->m_bin.write(log_binary::MAGIC, sizeof(log_binary::MAGIC));
+    this->m_bin.write((const char*)&this->m_clock_offset, 8);
+    this->m_bin_written += 1 + sizeof(log_binary::MAGIC) + 8;
+    this->m_bin_defined.clear();
+    return true;
+}
+
+
+/**
+ * @description: 写入二进制日志，不做格式化；文件达到 m_max_size 时与日志文件一样备份
+ * @param {string} record: 日志内容 (格式编号与参数)
+ * @param {uint64_t} stamp: 写入时刻 (steady_clock 纳秒)
+ */
+void CppLog::writeBinary(const std::string &record, uint64_t stamp) {
+    if (this->m_bin.is_open() && this->m_backup && this->m_bin_written >= this->m_max_size * 1024 * 1024) {
+        std::string full_path = this->binaryPath();
+        std::string new_name = backupName(full_path);
+
+        this->m_bin.close();
+        rename(full_path.c_str(), new_name.c_str());
+    }
+    if (!this->m_bin.is_open() && !this->openBinary()) {
+        return;
+    }
+
+    /* 格式编号在本会话中第一次出现，先写入格式字符串 */
+    uint32_t id;
+    std::memcpy(&id, record.data(), 4);
+    if (id >= this->m_bin_defined.size()) {
+        this->m_bin_defined.resize(id + 1, false);
+    }
+    if (!this->m_bin_defined[id]) {
+        std::string format = formatOf(id);
+        uint32_t length = (uint32_t)format.size();
+        char kind = (char)log_binary::FORMAT;
+        this->m_bin.write(&kind, 1);
+        this->m_bin.write((const char*)&id, 4);
+        this->m_bin.write((const char*)&length, 4);
+        this->m_bin.write(format.data(), length);
+        this->m_bin_written += 9 + length;
+        this->m_bin_defined[id] = true;
+    }
+
+    uint32_t length = (uint32_t)record.size();
+    char kind = (char)log_binary::RECORD;
+    this->m_bin.write(&kind, 1);
+    this->m_bin.write((const char*)&stamp, 8);
+    this->m_bin.write((const char*)&length, 4);
+    this->m_bin.write(record.data(), length);
+    this->m_bin_written += 13 + length;
 }
 
 /**
  * @description: 不带时间写入日志
  * @param {string} str: 写入日志的内容
  */
-void CppLog::write(const std::string str) {
-    this->open(this->m_name);
+void CppLog::write(const std::string &str) {
     this->backup();
     this->m_fp << str << '\n';
+    this->m_written += str.size() + 1;
+}
+
+
+/**
+ * @description: 获取当前线程在本日志对象中的缓冲区，首次调用时创建并登记
+ * @return {LogRing *}: 当前线程的缓冲区
+ */
+LogRing *CppLog::localRing() {
+    // 线程退出时通知日志线程，缓冲区写完后由日志线程移除
+    struct LocalRings {
+        std::vector<std::pair<uint64_t, std::shared_ptr<LogRing>>> rings;  // (日志对象编号, 缓冲区)
+
+        ~LocalRings() {
+            for (const std::pair<uint64_t, std::shared_ptr<LogRing>> &ring : this->rings) {
+                ring.second->closeProducer();
+            }
+        }
+    };
+    static thread_local uint64_t last_id = 0;  // 最近一次使用的日志对象编号
+    static thread_local LogRing *last_ring = nullptr;
+    static thread_local LocalRings local;
+
+    if (last_id == this->m_id) {
+        return last_ring;
+    }
+
+    /* 查找，顺便释放已析构的日志对象的缓冲区 */
+    LogRing *found = nullptr;
+    for (size_t i = 0; i < local.rings.size();) {
+        if (local.rings[i].first == this->m_id) {
+            found = local.rings[i].second.get();
+        }
+        else if (local.rings[i].second->consumerClosed()) {
+            local.rings.erase(local.rings.begin() + i);
+            continue;
+        }
+        ++i;
+    }
+
+    /* 首次写日志，创建并登记 */
+    if (found == nullptr) {
+        std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+        {
+            std::unique_lock<std::mutex> lock(this->m_mutex);
+            this->m_rings.push_back(ring);
+        }
+        local.rings.push_back(std::make_pair(this->m_id, ring));
+        found = ring.get();
+    }
+
+    last_id = this->m_id;
+    last_ring = found;
+    return found;
+}
+
+
+/**
+ * @description: 唤醒日志线程，加锁保证日志线程要么还未检查缓冲区，要么已在等待
+ */
+void CppLog::wakeUp() {
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_sleeping.store(false, std::memory_order_relaxed);
+    }
+    this->m_condition.notify_one();
+}
+
+
+/**
+ * @description: 写入当前线程的缓冲区，缓冲区已满时唤醒日志线程并等待
+ * @param {const char *} str: 日志内容
+ * @param {size_t} length: 字节数，超过 LogRing::MAX_MESSAGE 的部分截断
+ * @param {int} flag: 是否记录时间
+ */
+void CppLog::push(const char *str, size_t length, int flag) {
+    if (length > LogRing::MAX_MESSAGE) {
+        length = LogRing::MAX_MESSAGE;
+    }
+    LogRing *ring = this->localRing();
+    uint64_t stamp = logTick();
+
+    while (!ring->tryPush(stamp, flag, str, length)) {
+        this->wakeUp();
+        std::this_thread::yield();
+    }
+
+    // 与日志线程的 m_sleeping.store(true) 配对: 要么日志线程看到本条日志，要么这里看到它准备休眠
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->m_sleeping.load(std::memory_order_relaxed)) {
+        this->wakeUp();
+    }
+}
+
+
+/**
+ * @description: 是否有未写入的日志，调用时需持有 m_mutex
+ * @return {bool}
+ */
+bool CppLog::pending() {
+    for (const std::shared_ptr<LogRing> &ring : this->m_rings) {
+        if (!ring->empty()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
 /**
- * @description: 日志线程工作函数
+ * @description: 日志线程工作函数，没有日志时先等待 LINGER，仍没有则休眠；之后取各线程缓冲区中已写入的全部日志，
+ *               按写入时刻合并后整批写入，只刷新一次；日志类停止后写完剩余日志再退出
  */
 void CppLog::working() {
-    while (m_start || !m_taskQ.empty()) {
-        while (!m_taskQ.empty()) {
-            m_mutex.lock();  // 加锁，保护共享资源
-            std::pair<std::string, int> pair = m_taskQ.front();
-            m_taskQ.pop();
-            m_mutex.unlock();  // 解锁
-
-            if (pair.second > 0) {  // 如果标志大于 0，调用带时间的
-                writeWithTime(pair.first);
+    std::vector<std::shared_ptr<LogRing>> rings;  // 本批次的缓冲区
+    std::vector<uint64_t> pos, end;  // 各缓冲区本批次的读位置与末尾
+    std::vector<LogRing::Header> next;  // 各缓冲区的下一条记录头
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->m_mutex);
+            bool deep = false;  // 等待 LINGER 后仍没有日志，改为休眠直到被唤醒
+            while (true) {
+                if (deep) {
+                    this->m_sleeping.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);  // 与 push() 中的栅栏配对
+                }
+                if (!this->m_start || this->pending()) {
+                    break;
+                }
+                if (deep) {
+                    this->m_condition.wait(lock);
+                }
+                else {
+                    this->m_condition.wait_for(lock, LINGER);
+                    deep = true;
+                }
+            }
+            this->m_sleeping.store(false, std::memory_order_relaxed);
+
+            if (!this->m_start && !this->pending()) {  // 已停止且没有剩余日志
+                break;
+            }
+
+            /* 移除线程已退出且已写完的缓冲区 */
+            for (size_t i = 0; i < this->m_rings.size();) {
+                if (this->m_rings[i]->producerClosed() && this->m_rings[i]->empty()) {
+                    this->m_rings.erase(this->m_rings.begin() + i);
+                    continue;
+                }
+                ++i;
+            }
+            rings = this->m_rings;
+        }
+
+        if (!this->m_fp.is_open()) {
+            this->open(this->m_name);
+        }
+        this->calibrate();
+
+        /* 按写入时刻合并各缓冲区 */
+        size_t n = rings.size();
+        pos.resize(n);
+        end.resize(n);
+        next.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            pos[i] = rings[i]->tail();
+            end[i] = rings[i]->head();
+            if (pos[i] != end[i]) {
+                rings[i]->read(pos[i], &next[i], sizeof(LogRing::Header));
+            }
+        }
+
+        while (true) {
+            size_t best = n;
+            for (size_t i = 0; i < n; ++i) {
+                if (pos[i] != end[i] && (best == n || next[i].stamp < next[best].stamp)) {
+                    best = i;
+                }
+            }
+            if (best == n) {
+                break;
+            }
+
+            LogRing::Header &header = next[best];
+            this->m_line.resize(header.length);
+            rings[best]->read(pos[best] + sizeof(LogRing::Header), &this->m_line[0], header.length);
+            if (header.flag == LogRing::BINARY) {
+                this->writeBinary(this->m_line, this->toSteady(header.stamp));
+            }
+            else if (header.flag > 0) {  // 如果标志大于 0，调用带时间的
+                this->writeWithTime(this->m_line, this->toSteady(header.stamp));
             }
             else {
-                write(pair.first);
+                this->write(this->m_line);
+            }
+
+            pos[best] += sizeof(LogRing::Header) + header.length;
+            if (pos[best] != end[best]) {
+                rings[best]->read(pos[best], &next[best], sizeof(LogRing::Header));
             }
         }
+
+        for (size_t i = 0; i < n; ++i) {
+            rings[i]->consume(pos[i]);
+        }
+        this->m_fp.flush();
+        if (this->m_bin.is_open()) {
+            this->m_bin.flush();
+        }
     }
 }
 
 
 /**
- * @description: 外部调用，向任务队列添加任务
- * @param {string} str: 需要记录的日志内容，默认值为 1
+ * @description: 外部调用，添加日志；只写入当前线程的缓冲区，不加锁
+ * @param {string} str: 需要记录的日志内容，超过 LogRing::MAX_MESSAGE 字节的部分截断
  * @param {int} flag: 是否记录时间，当数值给定数值大于 0 时记录时间，否则不记录时间，默认记录时间
  */
-void CppLog::addTask(std::string str, int flag) {
-    m_mutex.lock();
-    m_taskQ.push(std::make_pair(str, flag));  // 将任务加入工作队列中
-    m_mutex.unlock();
+void CppLog::addTask(const std::string &str, int flag) {
+    this->push(str.data(), str.size(), flag > 0 ? 1 : 0);
 }
 
+
+/**
+ * @description: 外部调用，添加日志；只写入当前线程的缓冲区，不加锁
+ * @param {const char *} str: 需要记录的日志内容，以 '\0' 结尾
+ * @param {int} flag: 是否记录时间，当数值给定数值大于 0 时记录时间，否则不记录时间，默认记录时间
+ */
+void CppLog::addTask(const char *str, int flag) {
+    this->push(str, std::strlen(str), flag > 0 ? 1 : 0);
+}
+
+
+/**
+ * @description: 登记二进制日志的格式字符串，每个调用点只登记一次 (见 CPPLOG_BINARY)
+ * @param {const char *} format: printf 风格的格式字符串
+ * @return {uint32_t}: 格式编号
+ */
+uint32_t CppLog::registerFormat(const char *format) {
+    FormatTable &table = formatTable();
+    std::unique_lock<std::mutex> lock(table.mutex);
+    table.formats.push_back(format);
+    return (uint32_t)(table.formats.size() - 1);
+}
+
+
+/**
+ * @description: 获取格式编号对应的格式字符串
+ * @param {uint32_t} id: 格式编号
+ * @return {std::string}: 格式字符串，编号无效时为空
+ */
+std::string CppLog::formatOf(uint32_t id) {
+    FormatTable &table = formatTable();
+    std::unique_lock<std::mutex> lock(table.mutex);
+    return id < table.formats.size() ? table.formats[id] : std::string();
+}
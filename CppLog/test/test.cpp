@@ -10,10 +10,19 @@
 
 
 #include "CppLog.h"
+#include "LogDecode.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <chrono>
 #include <thread>
+#include <vector>
+#include <dirent.h>
 #include <unistd.h>
 
 CppLog c;
@@ -39,12 +48,208 @@ void func2() {
     c.addTask("结束", 0);
 }
 
+/**
+ * @description: 二进制日志往返测试: 编码后按 logdecode 的逻辑解码，与 snprintf 的结果比较；
+ *               再经 CppLog 写入二进制日志文件，逐条读回比较文本与写入时刻
+ */
+void testBinaryRoundTrip() {
+    /* 单条日志内容 */
+    const char *format = "%s=%d u=%u ll=%lld hex=%#x f=%.3f e=%e c=%c [%-6s] %5.1f%%";
+    char expected[512];
+    snprintf(expected, sizeof(expected), format, "key", -42, 7u, -1234567890123LL, 255u, 3.14159, 1e-9, 'z', "ab", 99.44);
+
+    char record[log_binary::MAX_RECORD];
+    size_t length = log_binary::encode(record, 0, std::string("key"), -42, 7u, -1234567890123LL, 255u, 3.14159, 1e-9, 'z', "ab", 99.44);
+    std::vector<log_binary::Arg> args;
+    assert(log_binary::decodeArgs(record + 5, record + length, (uint8_t)record[4], args));
+    assert(log_binary::formatMessage(format, args) == expected);
+
+    /* 缺少参数与截断的内容 */
+    std::vector<log_binary::Arg> none;
+    assert(log_binary::formatMessage("a %d b", none) == "a <?> b");
+    assert(!log_binary::decodeArgs(record + 5, record + length - 1, (uint8_t)record[4], args));
+
+    /* 经日志文件往返 */
+    char dir[] = "/tmp/cpplog_test_XXXXXX";
+    assert(mkdtemp(dir) != nullptr);
+    int64_t before = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    {
+        CppLog log(2, dir, LogMode::WRITEONLY);
+        for (int i = 0; i < 100; i++) {
+            CPPLOG_BINARY(log, "第 %d 条: %s %.2f", i, "hello", i * 0.5);
+        }
+        CPPLOG_BINARY(log, "没有参数");
+    }
+    int64_t after = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::string bin_path = std::string(dir) + "/log.bin";
+    std::ifstream in(bin_path, std::ifstream::binary);
+    assert(in);
+    log_binary::Reader reader(in);
+    log_binary::Entry entry;
+    int64_t last = 0;
+    for (int i = 0; i < 101; i++) {
+        assert(reader.next(entry) == log_binary::Reader::ENTRY);
+        assert(entry.complete);
+        char text[64];
+        snprintf(text, sizeof(text), "第 %d 条: %s %.2f", i, "hello", i * 0.5);
+        assert(entry.message == (i < 100 ? std::string(text) : std::string("没有参数")));
+        assert(entry.wall >= last);
+        assert(entry.wall > before - 1000000000 && entry.wall < after + 1000000000);  // 允许 1 秒的换算误差
+        last = entry.wall;
+    }
+    assert(reader.next(entry) == log_binary::Reader::END);
+    in.close();
+
+    std::remove(bin_path.c_str());
+    std::remove((std::string(dir) + "/log.txt").c_str());
+    rmdir(dir);
+    std::cout << "二进制日志往返: 通过" << std::endl;
+}
+
+
+/**
+ * @description: 不使用缓存格式化系统时间，作为 TimeCache 的对照
+ * @param {int64_t} wall: 系统时间 (纳秒)
+ * @param {TimeFormat} tf: 时间格式
+ * @param {int} precision: 秒以下的位数
+ * @return {std::string}: 时间字符串
+ */
+std::string expectedTime(int64_t wall, TimeFormat tf, int precision) {
+    char text[20];
+    std::string result(text, CppLog::formatSecond((std::time_t)(wall / 1000000000), tf, text));
+    if (precision > 0 && tf != TimeFormat::YMDA && tf != TimeFormat::YMDB) {
+        char fraction[16];
+        snprintf(fraction, sizeof(fraction), ".%09lld", (long long)(wall % 1000000000));
+        result.append(fraction, 1 + precision);
+    }
+    return result;
+}
+
+
+/**
+ * @description: 时间缓存测试: 跨秒、跨分钟与跨小时的时间，各时间格式与精度，以及格式或精度改变后的缓存失效
+ */
+void testTimeCache() {
+    const TimeFormat formats[] = { TimeFormat::FULLA, TimeFormat::FULLB, TimeFormat::YMDA, TimeFormat::YMDB, TimeFormat::TIMEONLY };
+    int64_t start = 1760000000 - 1760000000 % 3600 - 3;  // 整点前 3 秒，依次跨过秒、分钟与小时
+    start = start * 1000000000 + 123456789;
+
+    TimeCache cache;  // 所有格式与精度共用，每次切换都使缓存失效
+    size_t length;
+    for (int round = 0; round < 2; ++round) {  // 第二轮在上一轮的缓存之后切换格式
+        for (TimeFormat tf : formats) {
+            for (int precision = 0; precision <= 9; ++precision) {
+                int64_t wall = start;
+                for (int step = 0; step < 200; ++step) {
+                    const char *text = cache.format(wall, tf, precision, length);
+                    assert(std::string(text, length) == expectedTime(wall, tf, precision));
+                    wall += step % 7 == 6 ? 61000000000LL : 37000001LL + step;  // 多数同一秒内前进，偶尔跨过一分钟
+                }
+                const char *text = cache.format(start, tf, precision, length);  // 回到之前的时间
+                assert(std::string(text, length) == expectedTime(start, tf, precision));
+            }
+        }
+    }
+    std::cout << "时间缓存: 通过" << std::endl;
+}
+
+
+/**
+ * @description: 列出目录中以指定前缀开头的文件
+ * @param {string} &dir: 目录
+ * @param {string} &prefix: 文件名前缀
+ * @return {std::vector<std::string>}: 文件路径
+ */
+std::vector<std::string> listFiles(const std::string &dir, const std::string &prefix) {
+    std::vector<std::string> files;
+    DIR *d = opendir(dir.c_str());
+    assert(d != nullptr);
+    while (struct dirent *entry = readdir(d)) {
+        std::string name(entry->d_name);
+        if (name.compare(0, prefix.size(), prefix) == 0) {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(d);
+    return files;
+}
+
+
+/**
+ * @description: 备份测试: 同一秒内多次备份不覆盖之前的文件，全部日志都保留在日志文件与备份中
+ */
+void testRotation() {
+    char dir[] = "/tmp/cpplog_test_XXXXXX";
+    assert(mkdtemp(dir) != nullptr);
+
+    const int lines = 200000, records = 100000;
+    const std::string line(40, 'x');  // 加上换行共 41 字节，约 8 MB，1 MB 备份一次
+    {
+        CppLog log(1, dir, LogMode::WRITEONLY);
+        for (int i = 0; i < lines; i++) {
+            log.addTask(line, 0);
+        }
+        for (int i = 0; i < records; i++) {
+            CPPLOG_BINARY(log, "第 %d 条", i);
+        }
+    }
+
+    std::vector<std::string> texts = listFiles(dir, "log.txt");
+    assert(texts.size() >= 8);
+    size_t counted = 0;
+    for (const std::string &path : texts) {
+        std::ifstream in(path);
+        std::string text;
+        while (std::getline(in, text)) {
+            assert(text == line);
+            ++counted;
+        }
+    }
+    assert(counted == (size_t)lines);
+
+    std::vector<std::string> bins = listFiles(dir, "log.bin");
+    assert(bins.size() >= 2);
+    std::vector<bool> seen(records, false);
+    for (const std::string &path : bins) {
+        std::ifstream in(path, std::ifstream::binary);
+        log_binary::Reader reader(in);
+        log_binary::Entry entry;
+        while (reader.next(entry) == log_binary::Reader::ENTRY) {
+            int i = std::atoi(entry.message.c_str() + std::strlen("第 "));
+            assert(i >= 0 && i < records && !seen[i]);
+            seen[i] = true;
+        }
+    }
+    assert(std::count(seen.begin(), seen.end(), true) == records);
+
+    for (const std::string &path : texts) {
+        std::remove(path.c_str());
+    }
+    for (const std::string &path : bins) {
+        std::remove(path.c_str());
+    }
+    rmdir(dir);
+    std::cout << "日志备份: 通过" << std::endl;
+}
+
+
 int main() {
+    testBinaryRoundTrip();
+    testRotation();
+    testTimeCache();
+
+
     c.setTimeFormat(TimeFormat::FULLB);
     std::thread t1(func1), t2(func2);
     t1.join();
     t2.join();
 
+    // 二进制日志，写入 ../Log/log.bin (日志文件 log.txt 对应的二进制日志文件)，用 logdecode 转换为文本
+    for (int i = 0; i < 3; i++) {
+        CPPLOG_BINARY(c, "二进制日志 %d: %s %.2f", i, "hello", i * 0.5);
+    }
+
     sleep(10);
 
     return 0;
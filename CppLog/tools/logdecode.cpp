@@ -0,0 +1,131 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 02:16:40
+ * @last_edit_time: 2026-10-18 04:10:37
+ * @file_path: /Tiny-Cpp-Frame/CppLog/tools/logdecode.cpp
+ * @description: 二进制日志解码工具: 将 log.bin 转换为与日志文件相同布局的文本
+ */
+
+
+#include "CppLog.h"
+#include "LogDecode.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static const char *USAGE =
+    "用法: logdecode <log.bin> [-t FULLA|FULLB|YMDA|YMDB|TIMEONLY|NONE] [-p 0-9]\n"
+    "  -t  时间格式，默认 FULLA；NONE 不输出时间\n"
+    "  -p  秒以下的位数，默认 0\n";
+
+
+/*
+***************************主函数***************************
+*/
+
+/**
+ * @description: 解析时间格式参数
+ * @param {string} name: 时间格式名称
+ * @param {TimeFormat} &tf: 输出
+ * @param {bool} &with_time: 输出，NONE 时为 false
+ * @return {bool} 名称有效返回 true
+ */
+bool parseTimeFormat(const std::string &name, TimeFormat &tf, bool &with_time) {
+    with_time = true;
+    if (name == "FULLA") tf = TimeFormat::FULLA;
+    else if (name == "FULLB") tf = TimeFormat::FULLB;
+    else if (name == "YMDA") tf = TimeFormat::YMDA;
+    else if (name == "YMDB") tf = TimeFormat::YMDB;
+    else if (name == "TIMEONLY") tf = TimeFormat::TIMEONLY;
+    else if (name == "NONE") with_time = false;
+    else return false;
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+    /* 参数 */
+    std::string path;
+    TimeFormat tf = TimeFormat::FULLA;
+    bool with_time = true;
+    int precision = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "-t" && i + 1 < argc) {
+            if (!parseTimeFormat(argv[++i], tf, with_time)) {
+                std::cerr << USAGE;
+                return 1;
+            }
+        }
+        else if (arg == "-p" && i + 1 < argc) {
+            precision = std::atoi(argv[++i]);
+            precision = precision < 0 ? 0 : (precision > 9 ? 9 : precision);
+        }
+        else if (path.empty() && arg[0] != '-') {
+            path = arg;
+        }
+        else {
+            std::cerr << USAGE;
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << USAGE;
+        return 1;
+    }
+    if (tf == TimeFormat::YMDA || tf == TimeFormat::YMDB) {
+        precision = 0;
+    }
+
+    std::ifstream in(path, std::ifstream::binary);
+    if (!in) {
+        std::cerr << "无法打开 " << path << '\n';
+        return 1;
+    }
+
+    /* 逐条解码 */
+    log_binary::Reader reader(in);
+    log_binary::Entry entry;
+    int64_t cached_second = -1;  // 同一秒内复用时间字符串
+    char now_t[20];
+    size_t now_length = 0;
+    size_t count = 0;
+
+    log_binary::Reader::Result result;
+    while ((result = reader.next(entry)) == log_binary::Reader::ENTRY) {
+        if (!entry.complete) {
+            std::cerr << "第 " << count + 1 << " 条日志的参数不完整\n";
+        }
+
+        if (with_time) {
+            int64_t second = entry.wall / 1000000000;
+            if (second != cached_second) {
+                now_length = CppLog::formatSecond((std::time_t)second, tf, now_t);
+                cached_second = second;
+            }
+            std::string time(now_t, now_length);
+            if (precision > 0) {
+                char fraction[16];
+                snprintf(fraction, sizeof(fraction), ".%09lld", (long long)(entry.wall % 1000000000));
+                time.append(fraction, 1 + precision);
+            }
+            while (time.length() < 20) time += " ";
+            std::cout << time << " --->  " << entry.message << '\n';
+        }
+        else {
+            std::cout << entry.message << '\n';
+        }
+        ++count;
+    }
+    if (result == log_binary::Reader::CORRUPT) {
+        std::cerr << path << " 不是二进制日志文件或已损坏\n";
+        return 1;
+    }
+
+    std::cerr << "已解码 " << count << " 条日志\n";
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 14:05:52
+ * @last_edit_time: 2026-10-17 14:05:52
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/bench/alloc_bench.cpp
+ * @description: 任务表示方式的内存分配次数基准测试
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "ThreadPool.h"
+
+/*
+***************************统计 operator new 调用次数***************************
+*/
+static std::atomic<size_t> g_allocations(0);
+
+void *operator new(size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	std::free(p);
+}
+
+
+static const size_t TASKS = 100000;  // 每轮任务数量
+static const size_t WARMUP = 1000;  // 预热任务数量，排除队列扩容、内存池首次申请等一次性开销
+
+int multiply(const int a, const int b) {
+	return a * b;
+}
+
+
+/**
+ * @description: 原先 submitTask 的任务表示: std::bind + std::function + make_shared<packaged_task> + 包装 std::function
+ * @param {size_t} n: 任务数量
+ * @return {long} 结果之和，防止被优化掉
+ */
+long legacyRepresentation(size_t n) {
+	SafeQueue<std::function<void()>> queue;
+	long sum = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		std::function<int()> nonparam_task_func = std::bind(multiply, (int)i, 3);
+		auto task_ptr = std::make_shared<std::packaged_task<int()>>(nonparam_task_func);
+		auto future = task_ptr->get_future();
+		std::function<void()> warpper_func = [task_ptr]() { (*task_ptr)(); };
+		queue.taskEnqueue(warpper_func, 1);
+
+		std::function<void()> func;
+		queue.taskDequeue(func);
+		func();
+		sum += future.get();
+	}
+
+	return sum;
+}
+
+
+/**
+ * @description: 现在的任务表示: 内存池分配的 promise + 内联存储的 Task
+ * @param {size_t} n: 任务数量
+ * @return {long} 结果之和，防止被优化掉
+ */
+long taskRepresentation(size_t n) {
+	SafeQueue<Task> queue;
+	long sum = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		std::promise<int> promise(std::allocator_arg, PoolAllocator<char>());
+		auto future = promise.get_future();
+		Task task(PromiseTask<int, int(*)(int, int), int, int>(std::move(promise), multiply, (int)i, 3));
+		queue.taskEnqueue(task, 1);
+
+		Task func;
+		queue.taskDequeue(func);
+		func();
+		sum += future.get();
+	}
+
+	return sum;
+}
+
+
+/**
+ * @description: 通过线程池提交任务，统计所有线程的内存分配
+ * @param {ThreadPool} &pool: 线程池
+ * @param {size_t} n: 任务数量
+ * @return {long} 结果之和，防止被优化掉
+ */
+long poolSubmit(ThreadPool &pool, size_t n) {
+	long sum = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		sum += pool.submitTask(multiply, (int)i, 3).get();
+	}
+
+	return sum;
+}
+
+
+/**
+ * @description: 运行一轮测试，打印每个任务的平均分配次数与耗时
+ * @param {const char *} name: 测试名称
+ * @param {Func} func: 测试函数，参数为任务数量
+ */
+template<typename Func>
+void measure(const char *name, Func func) {
+	func(WARMUP);
+
+	size_t before = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	long sum = func(TASKS);
+	auto end = std::chrono::steady_clock::now();
+	size_t allocations = g_allocations.load() - before;
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / TASKS;
+	std::printf("%-28s %10.2f allocs/task %10.1f ns/task   (checksum %ld)\n", name, (double)allocations / TASKS, ns, sum);
+}
+
+
+int main() {
+	std::printf("tasks per run: %zu\n", TASKS);
+
+	measure("legacy bind/packaged_task", legacyRepresentation);
+	measure("Task + pooled promise", taskRepresentation);
+
+	std::cout.setstate(std::ios::failbit);  // 屏蔽线程池的调试输出
+	{
+		ThreadPool pool(1, ThreadPoolWorkMode::FIXED_THREAD, TaskQueueMode::LOCK_FREE);
+		measure("ThreadPool::submitTask", [&pool](size_t n) { return poolSubmit(pool, n); });
+		pool.close();
+	}
+	std::cout.clear();
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 23:34:52
+ * @last_edit_time: 2026-10-17 23:34:52
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/bench/coroutine_bench.cpp
+ * @description: 协程基准测试 (C++20): co_await 切换到线程池、等待子协程与 PoolFuture 的开销，对比回调式续延
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+#include "PoolCoroutine.h"
+
+static const size_t HOPS = 100000;  // 每轮切换次数
+
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ * @description: 子协程，被 co_await 时在等待者的线程中执行
+ * @param {int} x: 参数
+ * @return {task<int>} x + 1
+ */
+coro::task<int> increment(int x) {
+	co_return x + 1;
+}
+
+
+/**
+ * @description: 反复切换到线程池，每次切换都是一次入队与出队
+ * @param {ThreadPool} &pool: 线程池
+ * @param {size_t} n: 切换次数
+ * @return {task<size_t>} 切换次数
+ */
+coro::task<size_t> hop(ThreadPool &pool, size_t n) {
+	size_t count = 0;
+	for (size_t i = 0; i < n; ++i) {
+		co_await pool.schedule();
+		++count;
+	}
+	co_return count;
+}
+
+
+/**
+ * @description: 反复等待子协程，不经过线程池
+ * @param {size_t} n: 等待次数
+ * @return {task<int>} 累加结果
+ */
+coro::task<int> nested(size_t n) {
+	int value = 0;
+	for (size_t i = 0; i < n; ++i) {
+		value = co_await increment(value);
+	}
+	co_return value;
+}
+
+
+/**
+ * @description: 反复等待线程池任务的 future，等待期间不占用线程
+ * @param {ThreadPool} &pool: 线程池
+ * @param {size_t} n: 等待次数
+ * @return {task<int>} 累加结果
+ */
+coro::task<int> awaitFutures(ThreadPool &pool, size_t n) {
+	int value = 0;
+	for (size_t i = 0; i < n; ++i) {
+		value = co_await pool.async([](int x) { return x + 1; }, value);
+	}
+	co_return value;
+}
+
+
+/**
+ * @description: 协程抛出的异常经 future 传递给调用者
+ * @param {ThreadPool} &pool: 线程池
+ * @return {task<void>}
+ */
+coro::task<void> fail(ThreadPool &pool) {
+	co_await pool.schedule();
+	throw std::runtime_error("coroutine failed");
+}
+
+
+/**
+ * @description: 对照组: 用回调链完成同样次数的切换，每一步在任务中提交下一步
+ */
+struct Chain {
+	ThreadPool *pool;
+	std::atomic<size_t> *remaining;
+
+	void operator()() {
+		if (this->remaining->fetch_sub(1) > 1)
+			this->pool->post(Chain{ this->pool, this->remaining });
+	}
+};
+
+
+/**
+ * @description: 打印一轮测试的耗时
+ * @param {const char *} name: 测试名称
+ * @param {Clock::time_point} start: 开始时刻
+ * @param {size_t} n: 操作次数
+ */
+void report(const char *name, Clock::time_point start, size_t n) {
+	double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	std::printf("%-24s %8zu ops   %8.1f ns/op\n", name, n, ns / n);
+}
+
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	std::cout.setstate(std::ios::failbit);  // 屏蔽线程池的调试输出
+
+	const ThreadPoolWorkMode modes[] = { ThreadPoolWorkMode::FIXED_THREAD, ThreadPoolWorkMode::WORK_STEALING };
+	for (ThreadPoolWorkMode mode : modes) {
+		ThreadPool pool(2, mode, TaskQueueMode::LOCK_FREE);
+		std::printf("%s\n", mode == ThreadPoolWorkMode::FIXED_THREAD ? "FIXED_THREAD" : "WORK_STEALING");
+
+		Clock::time_point start = Clock::now();
+		size_t hops = coro::spawn(pool, hop(pool, HOPS)).get();
+		report("co_await schedule()", start, hops);
+
+		std::atomic<size_t> remaining(HOPS);
+		start = Clock::now();
+		pool.post(Chain{ &pool, &remaining });
+		while (remaining.load() > 0)
+			std::this_thread::yield();
+		report("callback chain", start, HOPS);
+
+		start = Clock::now();
+		int value = coro::spawn(pool, nested(HOPS)).get();
+		report("co_await task<int>", start, (size_t)value);
+
+		start = Clock::now();
+		value = coro::spawn(pool, awaitFutures(pool, HOPS / 10)).get();
+		report("co_await PoolFuture", start, (size_t)value);
+
+		try {
+			coro::spawn(pool, fail(pool)).get();
+		}
+		catch (const std::runtime_error &e) {
+			std::printf("%-24s %s\n", "exception", e.what());
+		}
+
+		pool.close();
+	}
+
+	std::cout.clear();
+	return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 21:10:24
+ * @last_edit_time: 2026-10-17 21:10:24
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/bench/latency_bench.cpp
+ * @description: 任务分派延迟基准测试: 从提交到任务开始执行的耗时 (p50/p99)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "ThreadPool.h"
+
+static const size_t SAMPLES = 20000;  // 每轮采样数量
+static const size_t WARMUP = 500;  // 预热采样数量
+
+using Clock = std::chrono::steady_clock;
+
+
+/**
+ * @description: 逐个提交任务，任务开始执行时记录与提交时刻的差值；等待上一个任务完成并间隔 gap 后再提交下一个
+ * @param {ThreadPool} &pool: 线程池
+ * @param {size_t} n: 采样数量
+ * @param {microseconds} gap: 两次提交之间的间隔，间隔越长线程越可能已经休眠
+ * @return {std::vector<double>} 每个任务的分派延迟 (微秒)
+ */
+std::vector<double> dispatchLatency(ThreadPool &pool, size_t n, std::chrono::microseconds gap) {
+	std::vector<double> latencies(n);
+
+	for (size_t i = 0; i < n; ++i) {
+		Clock::time_point submit = Clock::now();
+		pool.submitTask([&latencies, i, submit]() {
+			latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - submit).count();
+		}).get();
+
+		if (gap.count() > 0) {
+			std::this_thread::sleep_for(gap);
+		}
+	}
+
+	return latencies;
+}
+
+
+/**
+ * @description: 运行一轮测试，打印分派延迟的 p50/p99
+ * @param {const char *} name: 测试名称
+ * @param {ThreadPoolWorkMode} mode: 线程池工作模式
+ * @param {size_t} spin: 自旋次数，0 表示取不到任务立即休眠
+ * @param {size_t} yield: 让出时间片次数
+ * @param {microseconds} gap: 两次提交之间的间隔
+ */
+void measure(const char *name, ThreadPoolWorkMode mode, size_t spin, size_t yield, std::chrono::microseconds gap) {
+	std::cout.setstate(std::ios::failbit);  // 屏蔽线程池的调试输出
+	ThreadPool pool(2, mode, TaskQueueMode::LOCK_FREE);
+	pool.setIdleSpin(spin, yield);
+
+	dispatchLatency(pool, WARMUP, gap);
+	size_t n = gap.count() > 0 ? SAMPLES / 10 : SAMPLES;
+	std::vector<double> latencies = dispatchLatency(pool, n, gap);
+	pool.close();
+	std::cout.clear();
+
+	std::sort(latencies.begin(), latencies.end());
+	double p50 = latencies[n / 2];
+	double p99 = latencies[n * 99 / 100];
+	std::printf("%-16s spin %5zu yield %3zu gap %6lldus   p50 %8.2f us   p99 %8.2f us\n",
+		name, spin, yield, (long long)gap.count(), p50, p99);
+}
+
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+	const std::chrono::microseconds gaps[] = { std::chrono::microseconds(0), std::chrono::microseconds(50), std::chrono::microseconds(1000) };
+	for (std::chrono::microseconds gap : gaps) {
+		measure("FIXED park", ThreadPoolWorkMode::FIXED_THREAD, 0, 0, gap);
+		measure("FIXED spin", ThreadPoolWorkMode::FIXED_THREAD, 1024, 16, gap);
+		measure("STEALING park", ThreadPoolWorkMode::WORK_STEALING, 0, 0, gap);
+		measure("STEALING spin", ThreadPoolWorkMode::WORK_STEALING, 1024, 16, gap);
+	}
+
+	return 0;
+}
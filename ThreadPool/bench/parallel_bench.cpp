@@ -0,0 +1,88 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 17:21:40
+ * @last_edit_time: 2026-10-17 17:21:40
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/bench/parallel_bench.cpp
+ * @description: 并行算法与 std:: 串行版本的对比基准测试
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ParallelAlgorithms.h"
+
+static const int REPEAT = 5;  // 每组重复次数，取最小值
+
+
+/**
+ * @description: 多次运行并返回最短耗时
+ * @param {Func} func: 测试函数
+ * @return {double} 毫秒
+ */
+template<typename Func>
+double bestOf(Func func) {
+	double best = 1e300;
+	for (int i = 0; i < REPEAT; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		best = ms < best ? ms : best;
+	}
+	return best;
+}
+
+
+/**
+ * @description: 打印一行结果
+ */
+void report(const char *name, size_t n, double serial, double parallel) {
+	std::printf("%-16s %10zu %12.3f %12.3f %9.2fx\n", name, n, serial, parallel, serial / parallel);
+}
+
+
+int main() {
+	std::cout.setstate(std::ios::failbit);  // 屏蔽线程池的调试输出
+
+	ThreadPool pool(std::thread::hardware_concurrency(), ThreadPoolWorkMode::WORK_STEALING);
+	pool.setTaskMaxAmount(1 << 16);
+
+	std::printf("threads: %zu\n", pool.getThreadsAmount());
+	std::printf("%-16s %10s %12s %12s %10s\n", "algorithm", "size", "serial(ms)", "parallel(ms)", "speedup");
+
+	std::mt19937 rng(20261017);
+	for (size_t n = 1000; n <= 10000000; n *= 10) {
+		std::vector<double> data(n);
+		std::vector<double> out(n);
+		for (size_t i = 0; i < n; ++i)
+			data[i] = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+
+		// for: 逐元素计算
+		auto kernel = [&](size_t i) { out[i] = std::sqrt(data[i]) * std::sin(data[i]); };
+		double serial = bestOf([&]() { for (size_t i = 0; i < n; ++i) kernel(i); });
+		double parallel = bestOf([&]() { parallel_for(pool, (size_t)0, n, kernel); });
+		report("parallel_for", n, serial, parallel);
+
+		// reduce: 求和
+		volatile double sink = 0;
+		serial = bestOf([&]() { sink = std::accumulate(data.begin(), data.end(), 0.0); });
+		parallel = bestOf([&]() { sink = parallel_reduce(pool, data.begin(), data.end(), 0.0); });
+		report("parallel_reduce", n, serial, parallel);
+
+		// sort: 每次排序前恢复为乱序数据
+		std::vector<double> work(n);
+		serial = bestOf([&]() { work = data; std::sort(work.begin(), work.end()); });
+		parallel = bestOf([&]() { work = data; parallel_sort(pool, work.begin(), work.end()); });
+		report("parallel_sort", n, serial, parallel);
+	}
+
+	pool.close();
+	std::cout.clear();
+	return 0;
+}
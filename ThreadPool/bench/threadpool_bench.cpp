@@ -0,0 +1,394 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 00:46:15
+ * @last_edit_time: 2026-10-18 00:46:15
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/bench/threadpool_bench.cpp
+ * @description: 线程池综合基准测试: 按线程数量与工作模式扫描多种负载，结果写入 JSON 文件以便版本间对比
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 负载规模，--quick 时缩小为 1/10
+static size_t THROUGHPUT_TASKS = 200000;  // 吞吐量: 空任务数量
+static size_t LATENCY_SAMPLES = 10000;  // 分派延迟: 采样数量
+static size_t FANOUT_WIDTH = 1000;  // 扇出/扇入: 每轮子任务数量
+static size_t FANOUT_ROUNDS = 50;  // 扇出/扇入: 轮数
+static int FORK_JOIN_N = 27;  // 嵌套分叉/汇合: fib(n)
+static const int FORK_JOIN_CUTOFF = 14;  // 嵌套分叉/汇合: 小于该值时串行计算
+static size_t PRIORITY_LOW = 20000;  // 优先级混合: 低优先级任务数量
+static const size_t PRIORITY_HIGH_EVERY = 10;  // 优先级混合: 每隔多少个低优先级任务提交一个高优先级任务
+static const std::chrono::microseconds TASK_WORK(2);  // 扇出与优先级混合中每个任务的计算时长
+
+
+/*
+***************************结果记录***************************
+*/
+
+struct Result {
+	std::string workload;  // 负载名称
+	std::string mode;  // 线程池工作模式
+	size_t threads;  // 线程数量
+	std::vector<std::pair<std::string, double>> metrics;  // 指标名与数值
+};
+
+
+/**
+ * @description: 线程池工作模式的名称
+ * @param {ThreadPoolWorkMode} mode: 工作模式
+ * @return {const char *} 名称
+ */
+const char *modeName(ThreadPoolWorkMode mode) {
+	switch (mode) {
+	case ThreadPoolWorkMode::FIXED_THREAD:
+		return "FIXED_THREAD";
+	case ThreadPoolWorkMode::MUTABLE_THREAD:
+		return "MUTABLE_THREAD";
+	default:
+		return "WORK_STEALING";
+	}
+}
+
+
+/**
+ * @description: 已排序样本的分位数
+ * @param {vector<double>} &sorted: 升序样本
+ * @param {double} p: 分位，如 0.99
+ * @return {double} 分位数，没有样本时为 0
+ */
+double percentile(const std::vector<double> &sorted, double p) {
+	if (sorted.empty())
+		return 0.0;
+	size_t i = (size_t)(p * (double)(sorted.size() - 1));
+	return sorted[i];
+}
+
+
+/**
+ * @description: 忙等待一段时间，模拟计算型任务
+ * @param {microseconds} d: 时长
+ */
+void spinFor(std::chrono::microseconds d) {
+	Clock::time_point end = Clock::now() + d;
+	while (Clock::now() < end) { }
+}
+
+
+/**
+ * @description: 等待线程池执行完指定数量的任务 (按 stats().executed 计算)
+ * @param {ThreadPool} &pool: 线程池
+ * @param {uint64_t} target: 目标执行数量
+ */
+void waitExecuted(ThreadPool &pool, uint64_t target) {
+	while (pool.stats().executed < target)
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+
+/*
+***************************负载***************************
+*/
+
+/**
+ * @description: 吞吐量: 外部线程连续提交空任务，直到全部执行完
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Result} &r: 结果
+ */
+void throughput(ThreadPool &pool, Result &r) {
+	uint64_t base = pool.stats().executed;
+
+	Clock::time_point start = Clock::now();
+	for (size_t i = 0; i < THROUGHPUT_TASKS; ++i)
+		pool.post([]() { });
+	waitExecuted(pool, base + THROUGHPUT_TASKS);
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	r.metrics.push_back(std::make_pair("tasks", (double)THROUGHPUT_TASKS));
+	r.metrics.push_back(std::make_pair("tasks_per_sec", (double)THROUGHPUT_TASKS / seconds));
+	r.metrics.push_back(std::make_pair("ns_per_task", seconds * 1e9 / (double)THROUGHPUT_TASKS));
+}
+
+
+/**
+ * @description: 分派延迟: 逐个提交任务并等待完成，记录从提交到开始执行的耗时
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Result} &r: 结果
+ */
+void latency(ThreadPool &pool, Result &r) {
+	std::vector<double> samples(LATENCY_SAMPLES);
+
+	for (size_t i = 0; i < LATENCY_SAMPLES; ++i) {
+		Clock::time_point submit = Clock::now();
+		pool.submitTask([&samples, i, submit]() {
+			samples[i] = std::chrono::duration<double, std::micro>(Clock::now() - submit).count();
+		}).get();
+	}
+
+	std::sort(samples.begin(), samples.end());
+	r.metrics.push_back(std::make_pair("samples", (double)LATENCY_SAMPLES));
+	r.metrics.push_back(std::make_pair("p50_us", percentile(samples, 0.50)));
+	r.metrics.push_back(std::make_pair("p90_us", percentile(samples, 0.90)));
+	r.metrics.push_back(std::make_pair("p99_us", percentile(samples, 0.99)));
+	r.metrics.push_back(std::make_pair("max_us", samples.back()));
+}
+
+
+/**
+ * @description: 扇出/扇入: 每轮批量提交一组计算任务，等最后一个完成后进入下一轮
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Result} &r: 结果
+ */
+void fanOut(ThreadPool &pool, Result &r) {
+	std::vector<double> rounds;
+
+	for (size_t round = 0; round < FANOUT_ROUNDS; ++round) {
+		std::atomic<size_t> remaining(FANOUT_WIDTH);
+
+		std::vector<std::function<void()>> tasks;
+		tasks.reserve(FANOUT_WIDTH);
+		for (size_t i = 0; i < FANOUT_WIDTH; ++i) {
+			tasks.push_back([&remaining]() {
+				spinFor(TASK_WORK);
+				remaining.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		Clock::time_point start = Clock::now();
+		pool.submitBatch(tasks.begin(), tasks.end());
+		while (remaining.load(std::memory_order_acquire) > 0)
+			std::this_thread::yield();
+		rounds.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+
+	std::sort(rounds.begin(), rounds.end());
+	double ideal = (double)FANOUT_WIDTH * std::chrono::duration<double, std::milli>(TASK_WORK).count() / (double)pool.getThreadsAmount();
+	r.metrics.push_back(std::make_pair("width", (double)FANOUT_WIDTH));
+	r.metrics.push_back(std::make_pair("p50_round_ms", percentile(rounds, 0.50)));
+	r.metrics.push_back(std::make_pair("p99_round_ms", percentile(rounds, 0.99)));
+	r.metrics.push_back(std::make_pair("efficiency", ideal / percentile(rounds, 0.50)));  // 理想耗时 / 实际耗时
+}
+
+
+/**
+ * @description: 串行计算斐波那契数
+ */
+long serialFib(int n) {
+	return n < 2 ? n : serialFib(n - 1) + serialFib(n - 2);
+}
+
+
+/**
+ * @description: 嵌套分叉/汇合: 一半递归提交到线程池，另一半在当前线程计算，等待期间协作执行其他任务
+ * @param {ThreadPool} &pool: 线程池
+ * @param {int} n: 参数
+ * @param {atomic<size_t>} &spawned: 提交的任务数量
+ * @return {long} fib(n)
+ */
+long forkJoinFib(ThreadPool &pool, int n, std::atomic<size_t> &spawned) {
+	if (n < FORK_JOIN_CUTOFF)
+		return serialFib(n);
+
+	spawned.fetch_add(1, std::memory_order_relaxed);
+	PoolFuture<long> left = pool.async(forkJoinFib, std::ref(pool), n - 1, std::ref(spawned));
+	long right = forkJoinFib(pool, n - 2, spawned);
+	return left.get() + right;
+}
+
+
+/**
+ * @description: 嵌套分叉/汇合，结果与串行计算对比
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Result} &r: 结果
+ */
+void forkJoin(ThreadPool &pool, Result &r) {
+	std::atomic<size_t> spawned(0);
+
+	Clock::time_point start = Clock::now();
+	long value = pool.async(forkJoinFib, std::ref(pool), FORK_JOIN_N, std::ref(spawned)).get();
+	double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	start = Clock::now();
+	long expected = serialFib(FORK_JOIN_N);
+	double serial = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	r.metrics.push_back(std::make_pair("n", (double)FORK_JOIN_N));
+	r.metrics.push_back(std::make_pair("tasks", (double)spawned.load()));
+	r.metrics.push_back(std::make_pair("ms", ms));
+	r.metrics.push_back(std::make_pair("speedup", serial / ms));
+	r.metrics.push_back(std::make_pair("correct", value == expected ? 1.0 : 0.0));
+}
+
+
+/**
+ * @description: 优先级混合: 低优先级任务积压时插入高优先级任务，分别统计从提交到开始执行的耗时
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Result} &r: 结果
+ */
+void priorityMix(ThreadPool &pool, Result &r) {
+	size_t high_amount = PRIORITY_LOW / PRIORITY_HIGH_EVERY;
+	std::vector<double> low(PRIORITY_LOW), high(high_amount);
+	std::atomic<size_t> finished(0);
+
+	for (size_t i = 0, h = 0; i < PRIORITY_LOW; ++i) {
+		Clock::time_point submit = Clock::now();
+		pool.setTaskPriority(1);
+		pool.post([&low, &finished, i, submit]() {
+			low[i] = std::chrono::duration<double, std::micro>(Clock::now() - submit).count();
+			spinFor(TASK_WORK);
+			finished.fetch_add(1, std::memory_order_release);
+		});
+
+		if (i % PRIORITY_HIGH_EVERY == PRIORITY_HIGH_EVERY - 1) {
+			submit = Clock::now();
+			pool.setTaskPriority(60);
+			pool.post([&high, &finished, h, submit]() {
+				high[h] = std::chrono::duration<double, std::micro>(Clock::now() - submit).count();
+				spinFor(TASK_WORK);
+				finished.fetch_add(1, std::memory_order_release);
+			});
+			++h;
+		}
+	}
+	while (finished.load(std::memory_order_acquire) < PRIORITY_LOW + high_amount)
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	pool.setTaskPriority(1);
+
+	std::sort(low.begin(), low.end());
+	std::sort(high.begin(), high.end());
+	r.metrics.push_back(std::make_pair("low_p50_us", percentile(low, 0.50)));
+	r.metrics.push_back(std::make_pair("low_p99_us", percentile(low, 0.99)));
+	r.metrics.push_back(std::make_pair("high_p50_us", percentile(high, 0.50)));
+	r.metrics.push_back(std::make_pair("high_p99_us", percentile(high, 0.99)));
+}
+
+
+/*
+***************************输出***************************
+*/
+
+/**
+ * @description: 将全部结果写入 JSON 文件
+ * @param {const char *} path: 文件路径
+ * @param {vector<Result>} &results: 结果
+ * @return {bool} 是否写入成功
+ */
+bool writeJson(const char *path, const std::vector<Result> &results) {
+	FILE *file = std::fopen(path, "w");
+	if (file == nullptr)
+		return false;
+
+	std::time_t now = std::time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	std::fprintf(file, "{\n");
+	std::fprintf(file, "  \"date\": \"%s\",\n", date);
+	std::fprintf(file, "  \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+#ifdef __VERSION__
+	std::fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+	std::fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result &r = results[i];
+		std::fprintf(file, "    {\"workload\": \"%s\", \"mode\": \"%s\", \"threads\": %zu", r.workload.c_str(), r.mode.c_str(), r.threads);
+		for (const std::pair<std::string, double> &m : r.metrics)
+			std::fprintf(file, ", \"%s\": %.6g", m.first.c_str(), m.second);
+		std::fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+
+	return std::fclose(file) == 0;
+}
+
+
+/**
+ * @description: 打印一行结果
+ * @param {Result} &r: 结果
+ */
+void print(const Result &r) {
+	std::printf("%-14s %-15s %3zu ", r.workload.c_str(), r.mode.c_str(), r.threads);
+	for (const std::pair<std::string, double> &m : r.metrics)
+		std::printf(" %s=%.4g", m.first.c_str(), m.second);
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+
+// 用法: threadpool_bench [输出文件，默认 threadpool_bench.json] [--quick]
+int main(int argc, char *argv[]) {
+	const char *output = "threadpool_bench.json";
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--quick") == 0) {
+			THROUGHPUT_TASKS /= 10;
+			LATENCY_SAMPLES /= 10;
+			FANOUT_ROUNDS /= 10;
+			FORK_JOIN_N -= 4;
+			PRIORITY_LOW /= 10;
+		}
+		else {
+			output = argv[i];
+		}
+	}
+
+	// 线程数量: 1, 2, 4, ... 直到硬件线程数 (线程池不允许超过硬件线程数)
+	size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<size_t> thread_counts;
+	for (size_t n = 1; n < hardware; n *= 2)
+		thread_counts.push_back(n);
+	thread_counts.push_back(hardware);
+
+	const ThreadPoolWorkMode modes[] = { ThreadPoolWorkMode::FIXED_THREAD, ThreadPoolWorkMode::MUTABLE_THREAD, ThreadPoolWorkMode::WORK_STEALING };
+	typedef void (*Workload)(ThreadPool &, Result &);
+	const std::pair<const char *, Workload> workloads[] = {
+		std::make_pair("throughput", &throughput),
+		std::make_pair("latency", &latency),
+		std::make_pair("fan_out", &fanOut),
+		std::make_pair("fork_join", &forkJoin),
+		std::make_pair("priority_mix", &priorityMix),
+	};
+
+	std::printf("hardware threads: %zu\n", hardware);
+	std::vector<Result> results;
+	for (size_t threads : thread_counts) {
+		for (ThreadPoolWorkMode mode : modes) {
+			for (const std::pair<const char *, Workload> &workload : workloads) {
+				// 每个负载使用新的线程池，任务队列足够长，提交不会因队列已满而等待
+				ThreadPool pool(threads, mode, TaskQueueMode::PRIORITY);
+				pool.setTaskMaxAmount(1 << 20);
+
+				Result r;
+				r.workload = workload.first;
+				r.mode = modeName(mode);
+				r.threads = threads;
+				workload.second(pool, r);
+				r.metrics.push_back(std::make_pair("stolen", (double)pool.stats().stolen));
+				pool.close();
+
+				print(r);
+				results.push_back(r);
+			}
+		}
+	}
+
+	if (!writeJson(output, results)) {
+		std::fprintf(stderr, "无法写入 %s\n", output);
+		return 1;
+	}
+	std::printf("results written to %s\n", output);
+	return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 21:42:06
+ * @last_edit_time: 2026-10-17 21:42:06
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/CpuTopology.h
+ * @description: CPU 拓扑头文件: 可用 CPU 集合、NUMA 节点与物理核心，以及工作线程的绑核顺序
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+***************************绑核策略***************************
+*/
+
+enum class AffinityMode : char {
+	NONE,  // 不绑核，线程由操作系统调度 (默认)
+	COMPACT,  // 紧凑: 依次占满一个 NUMA 节点的物理核心及其超线程，线程间共享缓存
+	SCATTER,  // 分散: 轮流分配到各个 NUMA 节点，节点内先占满物理核心再使用超线程
+	EXPLICIT  // 显式: 按给定的 CPU 编号列表依次绑定
+};
+
+
+/*
+***************************CPU 拓扑***************************
+*/
+
+// 可用 CPU 来自 sched_getaffinity (遵守 taskset 与 cgroup 限制)，NUMA 节点与物理核心来自 sysfs
+// 读取失败或非 Linux 平台时视为单个节点，每个 CPU 各自一个物理核心
+class CpuTopology {
+public:
+	struct Cpu {
+		int id;  // CPU 编号
+		int node;  // 所属 NUMA 节点
+		int core;  // 所属物理核心，取同一核心上编号最小的 CPU
+	};
+
+private:
+	std::vector<Cpu> m_cpus;  // 当前进程可用的 CPU，按编号排序
+	int m_nodes;  // NUMA 节点数量
+
+	static std::vector<int> parseCpuList(const std::string &);  // 解析 sysfs 的 CPU 列表，如 "0-3,8-11"
+	static std::string readFile(const std::string &);  // 读取 sysfs 文件的第一行
+
+public:
+	CpuTopology();  // 探测当前进程的 CPU 拓扑
+	explicit CpuTopology(const std::vector<Cpu> &);  // 使用给定的拓扑，不探测 (用于测试)
+
+	std::vector<int> order(AffinityMode, const std::vector<int> &) const;  // 按绑核策略排列的 CPU 编号，第 i 个线程绑定第 i % size 个
+	int nodeOf(int) const;  // CPU 所属的 NUMA 节点，未知时为 0
+	int nodes() const { return this->m_nodes; }  // NUMA 节点数量
+	size_t size() const { return this->m_cpus.size(); }  // 可用 CPU 数量
+
+	static bool pinCurrentThread(int);  // 将当前线程绑定到指定 CPU
+};
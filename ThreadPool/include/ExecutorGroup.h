@@ -0,0 +1,362 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 23:24:35
+ * @last_edit_time: 2026-10-17 23:24:35
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/ExecutorGroup.h
+ * @description: 执行组头文件: 一个线程池承载多类任务，按权重以差额轮询 (DRR) 公平分配工作线程，并可限制每类任务的并发数
+ */
+
+#ifndef EXECUTOR_GROUP_H__
+#define EXECUTOR_GROUP_H__
+
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+
+/*
+***************************执行组的共享状态***************************
+*/
+
+namespace group_detail {
+
+	static const size_t BATCH = 64;  // 一个执行槽连续执行的任务数量，之后重新排队，让出工作线程
+	static const long long QUANTUM = 100000;  // 每一轮每单位权重的额度 (纳秒)
+
+	struct Group {
+		std::string name;  // 组名
+		size_t weight;  // 权重
+		size_t cap;  // 并发上限
+		std::deque<Task> queue;  // 尚未执行的任务
+		size_t running;  // 正在执行的任务数量
+		long long deficit;  // 差额 (纳秒)，为正时才能执行任务，执行后扣除实际耗时
+		long long estimate;  // 任务耗时的滑动平均 (纳秒)，取出任务时预先扣除
+
+		Group(const std::string &n, size_t w, size_t c)
+			: name(n), weight(w == 0 ? 1 : w), cap(c == 0 ? static_cast<size_t>(-1) : c), running(0), deficit(0), estimate(10000) { }
+	};
+
+	struct State {
+		ThreadPool &pool;  // 执行任务的线程池
+		std::mutex mutex;  // 保护全部组的队列与差额，执行任务时不持有
+		std::vector<std::unique_ptr<Group>> groups;  // 全部组，只增不减
+		size_t cursor;  // 轮询位置
+		size_t slots;  // 线程池中 (排队或正在执行) 的执行槽数量
+		size_t max_slots;  // 执行槽上限，即线程数量
+
+		explicit State(ThreadPool &p) : pool(p), cursor(0), slots(0), max_slots(p.getThreadsAmount()) {
+			if (this->max_slots == 0)
+				this->max_slots = 1;
+		}
+
+		static bool eligible(const Group &g) { return !g.queue.empty() && g.running < g.cap; }
+
+		/**
+		 * @description: 当前需要的执行槽数量: 各组可以同时执行的任务数之和，不超过线程数量
+		 * @return {size_t} 执行槽数量
+		 */
+		size_t desired() const {
+			size_t total = 0;
+			for (const std::unique_ptr<Group> &g : this->groups) {
+				size_t want = g->queue.size() + g->running;
+				total += want < g->cap ? want : g->cap;
+				if (total >= this->max_slots)
+					return this->max_slots;
+			}
+			return total;
+		}
+
+		/**
+		 * @description: 差额轮询选出下一个执行任务的组: 轮到一个组时为其补充 weight * QUANTUM 的额度，
+		 *               额度为正时留在该组，用完后轮到下一个组；空闲的组不积累额度
+		 * @return {Group *} 选中的组，没有可执行的任务时为 nullptr
+		 */
+		Group *pick() {
+			bool any = false;
+			for (const std::unique_ptr<Group> &g : this->groups) {
+				any = any || eligible(*g);
+			}
+			if (!any) {
+				return nullptr;
+			}
+
+			size_t n = this->groups.size();
+			while (true) {
+				for (size_t i = 0; i < n; ++i) {
+					Group &g = *this->groups[this->cursor];
+					if (g.queue.empty() && g.deficit > 0)
+						g.deficit = 0;
+					if (eligible(g) && g.deficit > 0)
+						return &g;
+
+					this->cursor = (this->cursor + 1) % n;
+					Group &next = *this->groups[this->cursor];
+					if (eligible(next))
+						next.deficit += (long long)next.weight * QUANTUM;
+				}
+
+				// 可执行的组额度都为负 (刚执行过耗时很长的任务)，直接补足到最先转正的组所需的轮数
+				long long rounds = -1;
+				for (const std::unique_ptr<Group> &g : this->groups) {
+					if (!eligible(*g))
+						continue;
+					long long quantum = (long long)g->weight * QUANTUM;
+					long long need = (-g->deficit) / quantum + 1;
+					if (rounds < 0 || need < rounds)
+						rounds = need;
+				}
+				for (const std::unique_ptr<Group> &g : this->groups) {
+					if (eligible(*g))
+						g->deficit += rounds * (long long)g->weight * QUANTUM;
+				}
+			}
+		}
+	};
+
+	// 提交到线程池的执行槽: 每次按差额轮询取出一个任务执行，没有可执行的任务时退出
+	struct Slot {
+		std::shared_ptr<State> state;
+
+		void operator()() {
+			std::unique_lock<std::mutex> lock(this->state->mutex);
+
+			for (size_t executed = 0; ; ++executed) {
+				// 连续执行了一批，重新排到线程池队尾，线程池中的其他任务不会被饿死
+				if (executed == BATCH) {
+					lock.unlock();
+					Task next(Slot{ this->state });
+					if (this->state->pool.tryPost(next)) {
+						return ;
+					}
+					executed = 0;  // 任务队列已满，继续在当前线程执行
+					lock.lock();
+				}
+
+				Group *g = this->state->pick();
+				if (g == nullptr) {
+					this->state->slots--;
+					return ;
+				}
+
+				Task task(std::move(g->queue.front()));
+				g->queue.pop_front();
+				g->running++;
+				long long charged = g->estimate;
+				g->deficit -= charged;
+				lock.unlock();
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				task();  // 任务自行捕获异常
+				task = nullptr;
+				long long cost = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+				lock.lock();
+				g->running--;
+				g->deficit -= cost - charged;  // 按实际耗时修正预先扣除的额度
+				g->estimate += (cost - g->estimate) / 8;
+			}
+		}
+	};
+
+	/**
+	 * @description: 撤销提交失败的执行槽；若没有其他执行槽而仍有可执行的任务，由调用者在当前线程执行一个执行槽
+	 * @param {shared_ptr<State>} &state: 共享状态
+	 * @return {bool} 调用者是否需要在当前线程执行执行槽
+	 */
+	inline bool abandonSlot(const std::shared_ptr<State> &state) {
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->slots--;
+		if (state->slots == 0 && state->desired() > 0) {
+			state->slots++;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @description: 任务加入组的队列，执行槽不足时先向线程池提交执行槽，成功后任务才入队
+	 *               执行槽提交失败时只拒绝本任务；其他线程期间加入、依赖该执行槽的任务在当前线程执行
+	 * @param {shared_ptr<State>} &state: 共享状态
+	 * @param {Group} *group: 所属组
+	 * @param {Task} &&task: 任务
+	 * @return {bool} 是否提交成功；提交超时返回 false，future 得到 TaskAborted(REJECTED)；线程池已关闭时抛出异常
+	 */
+	inline bool dispatch(const std::shared_ptr<State> &state, Group *group, Task &&task) {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				group->queue.push_back(std::move(task));
+				if (state->slots >= state->desired()) {
+					return true;
+				}
+				task = std::move(group->queue.back());  // 需要新的执行槽，提交成功前不入队
+				group->queue.pop_back();
+				state->slots++;
+			}
+
+			// 先尝试不等待地提交，任务队列已满时按线程池的提交超时等待
+			bool posted = false;
+			try {
+				Task slot(Slot{ state });
+				posted = state->pool.tryPost(slot) || state->pool.post(Slot{ state });
+			}
+			catch (...) {
+				if (abandonSlot(state)) {
+					Slot{ state }();
+				}
+				throw;
+			}
+
+			if (!posted) {
+				if (abandonSlot(state)) {
+					Slot{ state }();
+				}
+				return false;
+			}
+			// 执行槽可能在任务入队前就已取不到任务而退出，重新检查
+		}
+	}
+
+}  // namespace group_detail
+
+
+/*
+***************************执行组***************************
+*/
+
+// 一类任务的提交入口，由 GroupScheduler::addGroup 创建；可复制，副本提交到同一个组
+class ExecutorGroup {
+private:
+	std::shared_ptr<group_detail::State> m_state;
+	group_detail::Group *m_group;
+
+	friend class GroupScheduler;
+
+	ExecutorGroup(const std::shared_ptr<group_detail::State> &state, group_detail::Group *group) : m_state(state), m_group(group) { }
+
+public:
+	/**
+	 * @description: 提交任务，返回 std::future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {std::future<decltype(f(args...))>} 任务函数形成的 future，提交失败时得到 TaskAborted(REJECTED)
+	 */
+	template <typename F, typename... Args>
+	auto submitTask(F &&f, Args &&...args) -> std::future<decltype(f(args...))> {
+		using func_return_type = typename std::result_of<F(Args...)>::type;
+		using promise_task_type = PromiseTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		std::promise<func_return_type> promise(std::allocator_arg, PoolAllocator<char>());
+		auto return_future = promise.get_future();
+
+		group_detail::dispatch(this->m_state, this->m_group, Task(promise_task_type(std::move(promise), std::forward<F>(f), std::forward<Args>(args)...)));
+
+		return return_future;
+	}
+
+	/**
+	 * @description: 提交任务，不返回 future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {bool} 是否提交成功
+	 */
+	template <typename F, typename... Args>
+	bool post(F &&f, Args &&...args) {
+		using detached_task_type = DetachedTask<typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		return group_detail::dispatch(this->m_state, this->m_group, Task(detached_task_type(std::forward<F>(f), std::forward<Args>(args)...)));
+	}
+
+	/**
+	 * @description: 提交任务，返回线程池 future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {PoolFuture<decltype(f(args...))>} 任务函数形成的 future
+	 */
+	template <typename F, typename... Args>
+	auto async(F &&f, Args &&...args) -> PoolFuture<decltype(f(args...))> {
+		using func_return_type = typename std::result_of<F(Args...)>::type;
+		using async_task_type = future_detail::AsyncTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		std::shared_ptr<future_detail::State<func_return_type>> state = future_detail::makeState<func_return_type>(&this->m_state->pool);
+
+		group_detail::dispatch(this->m_state, this->m_group, Task(async_task_type(state, std::forward<F>(f), std::forward<Args>(args)...)));
+
+		return PoolFuture<func_return_type>(state);
+	}
+
+	const std::string &name() const { return this->m_group->name; }  // 组名
+
+	/**
+	 * @description: 获取尚未执行的任务数量
+	 * @return {size_t} 任务数量
+	 */
+	size_t getPendingTasksAmount() const {
+		std::unique_lock<std::mutex> lock(this->m_state->mutex);
+		return this->m_group->queue.size();
+	}
+
+	/**
+	 * @description: 获取正在执行的任务数量
+	 * @return {size_t} 任务数量
+	 */
+	size_t getRunningTasksAmount() const {
+		std::unique_lock<std::mutex> lock(this->m_state->mutex);
+		return this->m_group->running;
+	}
+};
+
+
+/*
+***************************执行组调度器***************************
+*/
+
+// 用法:
+//   ThreadPool pool(8);
+//   GroupScheduler scheduler(pool);
+//   ExecutorGroup cpu = scheduler.addGroup("cpu", 4);      // 权重 4
+//   ExecutorGroup log = scheduler.addGroup("log", 1, 1);   // 权重 1，最多同时执行 1 个任务
+//   cpu.post(compute, data); log.post(write, line);
+// 各组都有积压时，按权重分配工作线程的执行时间 (以任务实际耗时计算)；空闲的组不占用线程，也不积累额度
+// 线程池中只有与线程数量相当的执行槽，直接提交到线程池的任务与各组任务同样排队
+class GroupScheduler {
+private:
+	std::shared_ptr<group_detail::State> m_state;
+
+public:
+	explicit GroupScheduler(ThreadPool &pool) : m_state(std::make_shared<group_detail::State>(pool)) { }
+	GroupScheduler(const GroupScheduler &) = delete;
+	GroupScheduler &operator=(const GroupScheduler &) = delete;
+
+	/**
+	 * @description: 添加一个执行组
+	 * @param {string} &name: 组名
+	 * @param {size_t} weight: 权重，0 视为 1
+	 * @param {size_t} cap: 并发上限，0 表示不限
+	 * @return {ExecutorGroup} 执行组
+	 */
+	ExecutorGroup addGroup(const std::string &name, size_t weight, size_t cap = 0) {
+		std::unique_lock<std::mutex> lock(this->m_state->mutex);
+		this->m_state->groups.emplace_back(new group_detail::Group(name, weight, cap));
+		return ExecutorGroup(this->m_state, this->m_state->groups.back().get());
+	}
+
+	/**
+	 * @description: 设置执行槽上限，默认为创建时线程池的线程数量
+	 * @param {size_t} amount: 执行槽上限
+	 */
+	void setMaxSlots(size_t amount) {
+		std::unique_lock<std::mutex> lock(this->m_state->mutex);
+		this->m_state->max_slots = amount == 0 ? 1 : amount;
+	}
+};
+
+#endif  // !EXECUTOR_GROUP_H__
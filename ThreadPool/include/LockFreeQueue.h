@@ -0,0 +1,255 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 10:05:37
+ * @last_edit_time: 2026-10-17 10:05:37
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/LockFreeQueue.h
+ * @description: 无锁有界多生产者多消费者任务队列头文件
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "TaskQueue.h"
+
+/*
+***************************无锁有界队列***************************
+*/
+
+// 环形缓冲区，每个槽位带一个序号:
+//   序号 == 入队位置        -> 槽位空闲，生产者可写入
+//   序号 == 出队位置 + 1    -> 槽位已写入，消费者可读取
+// 生产者/消费者各自只需一次 CAS 抢占位置，队列满或空时立即返回 false，不会阻塞
+// 容量在构造时确定；任务数量上限可以调低 (setCapacity)，生产者在抢占位置前检查，调高时不能超过容量
+// 不支持任务优先级，taskEnqueue 的优先级参数被忽略
+template<typename T>
+class LockFreeQueue : public TaskQueue<T> {
+private:
+	static const size_t CACHE_LINE = 64;  // 缓存行大小，入队/出队位置分开存放，避免伪共享
+
+	struct Cell {
+		std::atomic<size_t> sequence;  // 槽位序号
+		T data;  // 任务
+	};
+
+	std::vector<Cell> m_buffer;  // 环形缓冲区
+	const size_t m_capacity;  // 容量，即环形缓冲区的槽位数
+	std::atomic<size_t> m_limit;  // 任务数量上限，即线程池的最大任务量，不超过容量
+	char m_pad_enqueue[CACHE_LINE];  // 入队位置独占缓存行
+	std::atomic<size_t> m_enqueue_pos;  // 下一个入队位置
+	char m_pad_dequeue[CACHE_LINE];  // 出队位置独占缓存行
+	std::atomic<size_t> m_dequeue_pos;  // 下一个出队位置
+	char m_pad_back[CACHE_LINE];  // 与后面的数据隔开
+
+	size_t room(size_t pos) const;  // 入队位置为 pos 时距上限的剩余空间
+
+public:
+	/* 构造函数 */
+	explicit LockFreeQueue(size_t capacity);
+	LockFreeQueue(const LockFreeQueue &) = delete;
+	LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+	/* 析构函数 */
+	~LockFreeQueue() { }
+
+	/* 成员函数 */
+	bool empty() override;  // 队列是否为空
+	size_t safeQueueSize() override;  // 任务队列大小 (近似值)
+	size_t capacity() const { return this->m_capacity; }  // 队列容量
+	bool taskEnqueue(T &, size_t) override;  // 添加任务
+	size_t taskEnqueueBatch(T *, size_t, size_t) override;  // 批量添加任务
+	bool taskDequeue(T &) override;  // 取出任务
+	bool setCapacity(size_t) override;  // 设置任务数量上限
+};
+
+
+/**
+ * @description: 构造函数，分配环形缓冲区并初始化槽位序号
+ * @param {size_t} capacity: 队列容量，至少为 1
+ */
+template<typename T>
+LockFreeQueue<T>::LockFreeQueue(size_t capacity)
+	: m_buffer(capacity > 0 ? capacity : 1)
+	, m_capacity(capacity > 0 ? capacity : 1)
+	, m_limit(capacity > 0 ? capacity : 1)
+	, m_enqueue_pos(0)
+	, m_dequeue_pos(0)
+{
+	for (size_t i = 0; i < this->m_capacity; ++i) {
+		this->m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+
+/**
+ * @description: 判断任务队列是否为空
+ * @return {bool} true/false
+ */
+template<typename T>
+bool LockFreeQueue<T>::empty() {
+	return this->safeQueueSize() == 0;
+}
+
+
+/**
+ * @description: 获取任务队列大小，并发修改时为近似值
+ * @return {size_t} 入队位置 - 出队位置
+ */
+template<typename T>
+size_t LockFreeQueue<T>::safeQueueSize() {
+	size_t dequeue_pos = this->m_dequeue_pos.load(std::memory_order_acquire);
+	size_t enqueue_pos = this->m_enqueue_pos.load(std::memory_order_acquire);
+
+	return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
+
+
+/**
+ * @description: 入队位置为 pos 时距任务数量上限的剩余空间
+ *               读到的出队位置只会比实际的旧 (偏小)，估计的任务数量偏大，抢占到 pos 后任务数量不会超过上限
+ * @param {size_t} pos: 准备抢占的入队位置
+ * @return {size_t} 剩余空间
+ */
+template<typename T>
+size_t LockFreeQueue<T>::room(size_t pos) const {
+	size_t dequeue_pos = this->m_dequeue_pos.load(std::memory_order_acquire);
+	size_t size = pos > dequeue_pos ? pos - dequeue_pos : 0;
+	size_t limit = this->m_limit.load(std::memory_order_relaxed);
+
+	return size < limit ? limit - size : 0;
+}
+
+
+/**
+ * @description: 向任务队列添加任务
+ * @param {T} t: 任务函数，成功入队后被移走
+ * @param {size_t}: 任务优先级，无锁队列不支持优先级
+ * @return {bool} 队列已满或达到任务数量上限时返回 false
+ */
+template<typename T>
+bool LockFreeQueue<T>::taskEnqueue(T &t, size_t) {
+	size_t pos = this->m_enqueue_pos.load(std::memory_order_relaxed);
+	Cell *cell;
+
+	while (true) {
+		cell = &this->m_buffer[pos % this->m_capacity];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+		if (diff == 0) {  // 槽位空闲，抢占该位置
+			if (this->room(pos) == 0)  // 达到任务数量上限
+				return false;
+			if (this->m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0) {  // 槽位中的任务还没有被取走，队列已满
+			return false;
+		}
+		else {  // 位置已被其他生产者抢占，重新读取
+			pos = this->m_enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->data = std::move(t);
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+
+/**
+ * @description: 批量向任务队列添加任务，一次 CAS 抢占连续的空闲槽位
+ * @param {T} *tasks: 任务数组，成功入队的部分被移走
+ * @param {size_t} n: 任务数量
+ * @param {size_t}: 任务优先级，无锁队列不支持优先级
+ * @return {size_t} 实际入队的数量，队列剩余空间或距上限的空间不足时只入队前一部分
+ */
+template<typename T>
+size_t LockFreeQueue<T>::taskEnqueueBatch(T *tasks, size_t n, size_t) {
+	size_t pos = this->m_enqueue_pos.load(std::memory_order_relaxed);
+	size_t count = 0;
+
+	while (n > 0) {
+		// 统计从 pos 开始连续空闲的槽位，只有抢占到 pos 的生产者才能写入这些槽位，CAS 成功后它们不会被占用
+		size_t space = this->room(pos);
+		count = 0;
+		while (count < n && count < space) {
+			Cell &cell = this->m_buffer[(pos + count) % this->m_capacity];
+			if (cell.sequence.load(std::memory_order_acquire) != pos + count)
+				break;
+			++count;
+		}
+
+		if (count > 0) {
+			if (this->m_enqueue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+				break;
+			continue;  // CAS 失败时 pos 已被更新
+		}
+
+		intptr_t diff = (intptr_t)this->m_buffer[pos % this->m_capacity].sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+		if (diff < 0 || (diff == 0 && space == 0))  // 队列已满或达到任务数量上限
+			return 0;
+		pos = this->m_enqueue_pos.load(std::memory_order_relaxed);  // 位置已被其他生产者抢占，重新读取
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		Cell &cell = this->m_buffer[(pos + i) % this->m_capacity];
+		cell.data = std::move(tasks[i]);
+		cell.sequence.store(pos + i + 1, std::memory_order_release);
+	}
+
+	return count;
+}
+
+
+/**
+ * @description: 从任务队列取出任务
+ * @param {T} t: 获取任务函数的空函数
+ * @return {bool} 队列为空时返回 false
+ */
+template<typename T>
+bool LockFreeQueue<T>::taskDequeue(T &t) {
+	size_t pos = this->m_dequeue_pos.load(std::memory_order_relaxed);
+	Cell *cell;
+
+	while (true) {
+		cell = &this->m_buffer[pos % this->m_capacity];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+		if (diff == 0) {  // 槽位已写入，抢占该位置
+			if (this->m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0) {  // 槽位尚未写入，队列为空
+			return false;
+		}
+		else {  // 位置已被其他消费者抢占，重新读取
+			pos = this->m_dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	t = std::move(cell->data);
+	cell->data = T();  // 释放槽位中残留的资源
+	cell->sequence.store(pos + this->m_capacity, std::memory_order_release);
+
+	return true;
+}
+
+
+/**
+ * @description: 设置任务数量上限，环形缓冲区不会扩容，超过容量时拒绝
+ * @param {size_t} limit: 任务数量上限
+ * @return {bool} 超过容量返回 false，上限保持不变
+ */
+template<typename T>
+bool LockFreeQueue<T>::setCapacity(size_t limit) {
+	if (limit > this->m_capacity)
+		return false;
+
+	this->m_limit.store(limit, std::memory_order_relaxed);
+
+	return true;
+}
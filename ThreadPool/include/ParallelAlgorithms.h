@@ -0,0 +1,401 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 16:08:33
+ * @last_edit_time: 2026-10-17 16:08:33
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/ParallelAlgorithms.h
+ * @description: 基于线程池的并行算法头文件: parallel_for / parallel_reduce / parallel_sort
+ */
+
+#ifndef PARALLEL_ALGORITHMS_H__
+#define PARALLEL_ALGORITHMS_H__
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "ThreadPool.h"
+
+/*
+***************************实现细节***************************
+*/
+
+// 分治方式: 惰性二分 (lazy binary splitting)
+//   1. 每个任务从自己的区间右侧不断对半拆出子任务，只有线程池 "缺活" 时 (排队任务少于线程数量) 才拆分，
+//      否则按粒度顺序处理，粒度之间重新判断，因此拆分次数随负载自动调整
+//   2. 任务队列已满时不拆分，直接在当前线程处理
+//   3. 汇合采用续延方式: 最后完成的子任务负责合并结果并通知上一层，任何线程都不会阻塞等待子任务
+//   4. 调用者执行根任务，之后在等待结束前帮助线程池执行任务
+namespace parallel_detail {
+
+	// 未指定粒度时，每个线程大约分到 AUTO_CHUNKS 份
+	static const size_t AUTO_CHUNKS = 8;
+
+
+	/**
+	 * @description: 计算拆分粒度
+	 * @param {size_t} n: 元素数量
+	 * @param {size_t} threads: 线程数量
+	 * @param {size_t} grain: 用户指定的粒度，0 表示自动
+	 * @return {size_t} 粒度，至少为 1
+	 */
+	inline size_t grainSize(size_t n, size_t threads, size_t grain) {
+		if (grain > 0)
+			return grain;
+		size_t auto_grain = n / ((threads > 0 ? threads : 1) * AUTO_CHUNKS);
+		return auto_grain > 0 ? auto_grain : 1;
+	}
+
+
+	// 整个并行算法共享的状态，位于调用者的栈上，调用者在全部任务完成后才返回
+	class ForkJoinState {
+	private:
+		std::atomic<bool> m_done;  // 是否全部完成
+		std::mutex m_exception_mutex;
+		std::exception_ptr m_exception;  // 第一个异常
+
+	public:
+		ThreadPool &pool;  // 所属线程池
+		size_t threads;  // 线程数量
+		size_t grain;  // 拆分粒度
+
+		ForkJoinState(ThreadPool &p, size_t n, size_t user_grain)
+			: m_done(false)
+			, pool(p)
+			, threads(p.getThreadsAmount())
+			, grain(grainSize(n, p.getThreadsAmount(), user_grain))
+		{ }
+
+		/**
+		 * @description: 线程池是否缺活，即排队的任务少于线程数量
+		 * @return {bool} true/false
+		 */
+		bool hungry() {
+			return this->pool.getPendingTasksAmount() < this->threads || this->pool.getIdleThreadsAmount() > 0;
+		}
+
+		/**
+		 * @description: 记录异常，只保留第一个
+		 */
+		void fail(std::exception_ptr e) {
+			std::unique_lock<std::mutex> lock(this->m_exception_mutex);
+			if (!this->m_exception)
+				this->m_exception = e;
+		}
+
+		bool failed() {
+			std::unique_lock<std::mutex> lock(this->m_exception_mutex);
+			return (bool)this->m_exception;
+		}
+
+		/**
+		 * @description: 标记全部完成，这是最后一次访问该对象，调用者随后可能立即销毁它
+		 */
+		void finish() {
+			this->m_done = true;
+		}
+
+		/**
+		 * @description: 协作式等待全部完成 (任务完成时线程池会唤醒等待者)，如有异常则重新抛出
+		 */
+		void wait() {
+			this->pool.helpUntil([this]() { return (bool)this->m_done; });
+
+			if (this->m_exception)
+				std::rethrow_exception(this->m_exception);
+		}
+
+		/**
+		 * @description: 提交子任务，失败时返回 false，由调用者在当前线程处理
+		 * @param {F} &&f: 无参函数
+		 * @return {bool} true/false
+		 */
+		template<typename F>
+		bool spawn(F &&f) {
+			Task task(std::forward<F>(f));
+			return this->pool.tryPost(task);
+		}
+	};
+
+
+	/*
+	***************************parallel_for***************************
+	*/
+	template<typename Index, typename Func>
+	struct ForState : ForkJoinState {
+		Func &func;
+		std::atomic<size_t> remaining;  // 尚未处理的元素数量
+
+		ForState(ThreadPool &p, size_t n, size_t user_grain, Func &f)
+			: ForkJoinState(p, n, user_grain), func(f), remaining(n) { }
+	};
+
+
+	/**
+	 * @description: 处理区间 [first, last)，缺活时从右侧拆出子任务
+	 */
+	template<typename Index, typename Func>
+	void forRange(ForState<Index, Func> *state, Index first, Index last) {
+		size_t processed = (size_t)(last - first);
+
+		try {
+			while ((size_t)(last - first) > state->grain) {
+				if (state->hungry()) {
+					Index mid = first + (last - first) / 2;
+					if (state->spawn([state, mid, last]() { forRange(state, mid, last); })) {
+						processed -= (size_t)(last - mid);
+						last = mid;
+						continue;
+					}
+				}
+
+				// 不需要拆分，顺序处理一个粒度后重新判断
+				Index stop = first + (Index)state->grain;
+				for (; first != stop; ++first)
+					state->func(first);
+			}
+
+			for (; first != last; ++first)
+				state->func(first);
+		}
+		catch (...) {
+			state->fail(std::current_exception());
+		}
+
+		if (state->remaining.fetch_sub(processed) == processed)
+			state->finish();
+	}
+
+
+	/*
+	***************************parallel_reduce***************************
+	*/
+	template<typename Iterator, typename T, typename BinaryOp>
+	struct ReduceState : ForkJoinState {
+		BinaryOp &op;
+		std::atomic<size_t> remaining;  // 尚未处理的元素数量
+		std::mutex result_mutex;
+		bool has_result;  // 是否已有部分结果
+		T result;  // 各任务部分结果的合并
+
+		ReduceState(ThreadPool &p, size_t n, size_t user_grain, BinaryOp &o, const T &init)
+			: ForkJoinState(p, n, user_grain), op(o), remaining(n), has_result(false), result(init) { }
+	};
+
+
+	/**
+	 * @description: 归约区间 [first, last)，缺活时从右侧拆出子任务，完成后将部分结果合并到共享结果中
+	 */
+	template<typename Iterator, typename T, typename BinaryOp>
+	void reduceRange(ReduceState<Iterator, T, BinaryOp> *state, Iterator first, Iterator last) {
+		size_t processed = (size_t)std::distance(first, last);
+
+		try {
+			T partial = *first;  // 区间非空
+			++first;
+
+			while ((size_t)std::distance(first, last) > state->grain) {
+				if (state->hungry()) {
+					Iterator mid = first + std::distance(first, last) / 2;
+					if (state->spawn([state, mid, last]() { reduceRange(state, mid, last); })) {
+						processed -= (size_t)std::distance(mid, last);
+						last = mid;
+						continue;
+					}
+				}
+
+				Iterator stop = first + state->grain;
+				for (; first != stop; ++first)
+					partial = state->op(std::move(partial), *first);
+			}
+
+			for (; first != last; ++first)
+				partial = state->op(std::move(partial), *first);
+
+			std::unique_lock<std::mutex> lock(state->result_mutex);
+			state->result = state->has_result ? state->op(std::move(state->result), std::move(partial)) : std::move(partial);
+			state->has_result = true;
+		}
+		catch (...) {
+			state->fail(std::current_exception());
+		}
+
+		if (state->remaining.fetch_sub(processed) == processed)
+			state->finish();
+	}
+
+
+	/*
+	***************************parallel_sort***************************
+	*/
+	template<typename Iterator, typename Compare>
+	struct SortState : ForkJoinState {
+		using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+		Compare &comp;
+		Iterator base;  // 待排序区间起点
+		std::vector<value_type> buffer;  // 归并缓冲区，与待排序区间一一对应
+
+		SortState(ThreadPool &p, Iterator first, Iterator last, size_t user_grain, Compare &c)
+			: ForkJoinState(p, (size_t)(last - first), user_grain), comp(c), base(first), buffer(first, last) { }
+	};
+
+
+	// 汇合点: 左右两半都排好序后，由最后完成的一方归并，再通知上一层
+	template<typename Iterator>
+	struct SortNode {
+		Iterator first, mid, last;
+		SortNode *parent;
+		std::atomic<int> pending;  // 尚未完成的一半的数量
+
+		SortNode(Iterator f, Iterator m, Iterator l, SortNode *p) : first(f), mid(m), last(l), parent(p), pending(2) { }
+	};
+
+
+	/**
+	 * @description: 一半已排好序，若另一半也已完成，则归并并继续向上汇合
+	 */
+	template<typename Iterator, typename Compare>
+	void sortComplete(SortState<Iterator, Compare> *state, SortNode<Iterator> *node) {
+		while (node != nullptr && node->pending.fetch_sub(1) == 1) {
+			if (!state->failed()) {
+				try {
+					auto out = state->buffer.begin() + (node->first - state->base);
+					std::merge(std::make_move_iterator(node->first), std::make_move_iterator(node->mid),
+						std::make_move_iterator(node->mid), std::make_move_iterator(node->last), out, state->comp);
+					std::move(out, out + (node->last - node->first), node->first);
+				}
+				catch (...) {
+					state->fail(std::current_exception());
+				}
+			}
+
+			SortNode<Iterator> *parent = node->parent;
+			delete node;
+			node = parent;
+		}
+
+		if (node == nullptr)
+			state->finish();
+	}
+
+
+	/**
+	 * @description: 排序区间 [first, last)，缺活时拆出右半部分，否则直接顺序排序
+	 */
+	template<typename Iterator, typename Compare>
+	void sortRange(SortState<Iterator, Compare> *state, Iterator first, Iterator last, SortNode<Iterator> *parent) {
+		while ((size_t)(last - first) > state->grain && state->hungry()) {
+			Iterator mid = first + (last - first) / 2;
+			SortNode<Iterator> *node = new SortNode<Iterator>(first, mid, last, parent);
+			if (!state->spawn([state, mid, last, node]() { sortRange(state, mid, last, node); })) {
+				delete node;
+				break;
+			}
+			parent = node;
+			last = mid;
+		}
+
+		try {
+			if (!state->failed())
+				std::sort(first, last, state->comp);
+		}
+		catch (...) {
+			state->fail(std::current_exception());
+		}
+
+		sortComplete(state, parent);
+	}
+
+}  // namespace parallel_detail
+
+
+/*
+***************************并行算法***************************
+*/
+
+/**
+ * @description: 并行执行 func(i)，i 取遍整数区间 [first, last)
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Index} first: 区间起点
+ * @param {Index} last: 区间终点
+ * @param {Func} func: 对每个下标执行的函数
+ * @param {size_t} grain: 拆分粒度，区间不大于粒度时不再拆分，0 表示自动
+ */
+template<typename Index, typename Func>
+void parallel_for(ThreadPool &pool, Index first, Index last, Func func, size_t grain = 0) {
+	static_assert(std::is_integral<Index>::value, "parallel_for requires an integral index");
+
+	if (first >= last)
+		return ;
+
+	parallel_detail::ForState<Index, Func> state(pool, (size_t)(last - first), grain, func);
+	parallel_detail::forRange(&state, first, last);
+	state.wait();
+}
+
+
+/**
+ * @description: 并行归约，与 std::reduce 相同，op 需满足结合律与交换律
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Iterator} first: 随机访问迭代器，区间起点
+ * @param {Iterator} last: 随机访问迭代器，区间终点
+ * @param {T} init: 初始值
+ * @param {BinaryOp} op: 二元归约函数
+ * @param {size_t} grain: 拆分粒度，0 表示自动
+ * @return {T} init 与区间内全部元素的归约结果
+ */
+template<typename Iterator, typename T, typename BinaryOp>
+T parallel_reduce(ThreadPool &pool, Iterator first, Iterator last, T init, BinaryOp op, size_t grain = 0) {
+	if (first == last)
+		return init;
+
+	parallel_detail::ReduceState<Iterator, T, BinaryOp> state(pool, (size_t)std::distance(first, last), grain, op, init);
+	parallel_detail::reduceRange(&state, first, last);
+	state.wait();
+
+	return op(std::move(init), std::move(state.result));
+}
+
+
+/**
+ * @description: 并行求和
+ */
+template<typename Iterator, typename T>
+T parallel_reduce(ThreadPool &pool, Iterator first, Iterator last, T init) {
+	return parallel_reduce(pool, first, last, init, [](T a, const T &b) { return a + b; });
+}
+
+
+/**
+ * @description: 并行归并排序，不稳定 (叶子区间使用 std::sort)，需要与区间等长的额外缓冲区
+ * @param {ThreadPool} &pool: 线程池
+ * @param {Iterator} first: 随机访问迭代器，区间起点
+ * @param {Iterator} last: 随机访问迭代器，区间终点
+ * @param {Compare} comp: 比较函数
+ * @param {size_t} grain: 叶子区间大小，0 表示自动
+ */
+template<typename Iterator, typename Compare>
+void parallel_sort(ThreadPool &pool, Iterator first, Iterator last, Compare comp, size_t grain = 0) {
+	if (last - first < 2)
+		return ;
+
+	parallel_detail::SortState<Iterator, Compare> state(pool, first, last, grain, comp);
+	parallel_detail::sortRange(&state, first, last, (parallel_detail::SortNode<Iterator>*)nullptr);
+	state.wait();
+}
+
+
+/**
+ * @description: 并行归并排序，升序
+ */
+template<typename Iterator>
+void parallel_sort(ThreadPool &pool, Iterator first, Iterator last) {
+	parallel_sort(pool, first, last, std::less<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+#endif  // !PARALLEL_ALGORITHMS_H__
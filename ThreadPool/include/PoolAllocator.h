@@ -0,0 +1,152 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:42:18
+ * @last_edit_time: 2026-10-17 11:42:18
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/PoolAllocator.h
+ * @description: 线程私有的小块内存池及其分配器，用于复用 future 的共享状态，以及基于它的定长对象池
+ */
+
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+***************************小块内存池***************************
+*/
+
+// 按 64 字节分级，每个线程为每一级维护一个空闲链表:
+//   释放的内存块挂到当前线程的链表上 (不要求与申请线程相同)，下次申请直接取出，无需调用 malloc
+//   任务在工作线程释放、在提交线程申请，内存会单向流动，因此链表过长时整批归还到全局仓库，链表为空时整批取回
+//   超过 MAX_BLOCK 的内存或仓库已满时直接使用 ::operator new / ::operator delete
+class MemoryPool {
+public:
+	static const size_t GRANULARITY = 64;  // 分级粒度
+	static const size_t MAX_BLOCK = 512;  // 池化的最大内存块
+	static const size_t CLASSES = MAX_BLOCK / GRANULARITY;  // 级数
+	static const size_t BATCH = 64;  // 与全局仓库交换的批量大小
+	static const size_t MAX_CACHED = 4 * BATCH;  // 每一级最多缓存的内存块数量
+	static const size_t MAX_DEPOT_BATCHES = 256;  // 全局仓库每一级最多保存的批数
+
+	static void *allocate(size_t);  // 申请内存
+	static void deallocate(void *, size_t);  // 释放内存
+
+private:
+	struct Block {
+		Block *next;
+	};
+
+	struct FreeList {  // 平凡类型，线程退出时仍可安全访问
+		Block *head;
+		size_t count;
+	};
+
+	struct Cleaner {  // 线程退出时归还缓存的内存块
+		~Cleaner();
+	};
+
+	struct Depot {  // 全局仓库，保存整批内存块，每批为一条长度为 BATCH 的链表
+		std::mutex mutex;
+		std::vector<Block*> batches[CLASSES];
+	};
+
+	static Depot &depot();  // 全局仓库，首次使用时构造，永不析构
+	static thread_local FreeList m_free_lists[CLASSES];  // 空闲链表
+	static thread_local bool m_exited;  // 线程是否已经退出，退出后不再缓存
+	static thread_local Cleaner m_cleaner;
+
+	static size_t classOf(size_t size) { return (size + GRANULARITY - 1) / GRANULARITY - 1; }
+};
+
+
+/*
+***************************内存池分配器***************************
+*/
+
+// 满足标准库分配器要求，可用于 std::promise(std::allocator_arg, PoolAllocator<T>()) 等
+template<typename T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind {
+		using other = PoolAllocator<U>;
+	};
+
+	PoolAllocator() noexcept { }
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U> &) noexcept { }
+
+	T *allocate(size_t n) { return static_cast<T*>(MemoryPool::allocate(n * sizeof(T))); }
+	void deallocate(T *p, size_t n) noexcept { MemoryPool::deallocate(p, n * sizeof(T)); }
+};
+
+template<typename T, typename U>
+inline bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) { return true; }
+
+template<typename T, typename U>
+inline bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) { return false; }
+
+
+/*
+***************************定长对象池***************************
+*/
+
+// 频繁创建销毁的定长对象直接复用内存池中的内存块，不经过 malloc:
+//   auto msg = ObjectPool<Message>::make(args...);  // std::unique_ptr，离开作用域时析构并归还
+// 可以在任意线程释放，内存块挂到释放线程的空闲链表上；超过 MemoryPool::MAX_BLOCK 的类型退化为 ::operator new
+template<typename T>
+class ObjectPool {
+public:
+	struct Deleter {
+		void operator()(T *p) const noexcept { ObjectPool<T>::destroy(p); }
+	};
+
+	using Ptr = std::unique_ptr<T, Deleter>;
+
+	/**
+	 * @description: 在内存池中构造对象
+	 * @param {Args} &&...args: 构造参数
+	 * @return {T *} 对象指针，需调用 destroy 释放
+	 */
+	template<typename... Args>
+	static T *create(Args &&...args) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool 不支持超过 max_align_t 的对齐");
+		void *p = MemoryPool::allocate(sizeof(T));
+		try {
+			return new (p) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			MemoryPool::deallocate(p, sizeof(T));
+			throw;
+		}
+	}
+
+	/**
+	 * @description: 析构对象并归还内存
+	 * @param {T *} p: 由 create 返回的对象指针
+	 */
+	static void destroy(T *p) noexcept {
+		if (p == nullptr) {
+			return ;
+		}
+		p->~T();
+		MemoryPool::deallocate(p, sizeof(T));
+	}
+
+	/**
+	 * @description: 构造对象并由 unique_ptr 管理
+	 * @param {Args} &&...args: 构造参数
+	 * @return {Ptr} 对象
+	 */
+	template<typename... Args>
+	static Ptr make(Args &&...args) {
+		return Ptr(create(std::forward<Args>(args)...));
+	}
+};
@@ -0,0 +1,322 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 23:34:52
+ * @last_edit_time: 2026-10-17 23:34:52
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/PoolCoroutine.h
+ * @description: 线程池协程头文件 (C++20): co_await pool.schedule()、惰性启动的 task<T>、可 co_await 的 PoolFuture
+ */
+
+#ifndef POOL_COROUTINE_H__
+#define POOL_COROUTINE_H__
+
+#if !defined(__cpp_impl_coroutine) || __cplusplus < 202002L
+#error "PoolCoroutine.h 需要 C++20 协程支持 (GCC 10 需加 -fcoroutines)"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+#include "PoolAllocator.h"
+
+// 用法:
+//   coro::task<int> fetch(ThreadPool &pool) {
+//       co_await pool.schedule();  // 之后在工作线程中执行
+//       int a = co_await pool.async(compute, 1);  // 等待期间不占用线程
+//       co_return a + co_await other(pool);  // 等待子协程
+//   }
+//   PoolFuture<int> f = coro::spawn(pool, fetch(pool));  // 在线程池中启动，非协程代码用 future 取结果
+namespace coro {
+
+	template<typename T = void>
+	class task;
+
+
+	/*
+	***************************切换到线程池***************************
+	*/
+
+	namespace coro_detail {
+
+		// 恢复协程的任务，只保存协程帧地址，放在 Task 的内联存储中，提交时不申请内存
+		struct Resume {
+			void *address;
+
+			void operator()() { std::coroutine_handle<>::from_address(this->address).resume(); }
+		};
+
+	}  // namespace coro_detail
+
+
+	// pool.schedule() 的返回值，挂起当前协程并将恢复任务提交到线程池
+	struct ScheduleAwaiter {
+		ThreadPool &pool;
+
+		explicit ScheduleAwaiter(ThreadPool &p) : pool(p) { }
+
+		bool await_ready() const noexcept { return false; }
+
+		/**
+		 * @description: 提交恢复任务；任务队列已满时等待，等待超时则不挂起，在当前线程继续执行；
+		 *               线程池已关闭时抛出异常，协程不挂起，异常在 co_await 处抛出
+		 * @param {coroutine_handle<>} handle: 当前协程
+		 * @return {bool} 是否挂起
+		 */
+		bool await_suspend(std::coroutine_handle<> handle) {
+			Task resume(coro_detail::Resume{ handle.address() });
+			if (this->pool.tryPost(resume))
+				return true;
+			return this->pool.post(coro_detail::Resume{ handle.address() });
+		}
+
+		void await_resume() const noexcept { }
+	};
+
+
+	/*
+	***************************惰性协程 task***************************
+	*/
+
+	namespace coro_detail {
+
+		// 与结果类型无关的部分: 协程帧由线程私有的内存池分配，结束时恢复等待者
+		// 不依赖对称转移: GCC 在未优化构建中不会把对称转移编译为尾调用，连续等待同步完成的子协程会栈溢出；
+		// 改为等待者与结束方各交换一次 finished，同步完成时等待者直接继续执行，异步完成时由结束方恢复等待者
+		struct PromiseBase {
+			std::coroutine_handle<> continuation;  // co_await 本协程的协程，结束时恢复它
+			std::exception_ptr exception;  // 协程抛出的异常
+			std::atomic<bool> finished{ false };  // 等待者与结束方先到的一方置位，后到的一方负责继续执行等待者
+
+			static void *operator new(size_t size) { return MemoryPool::allocate(size); }
+			static void operator delete(void *p, size_t size) { MemoryPool::deallocate(p, size); }
+
+			struct FinalAwaiter {
+				bool await_ready() const noexcept { return false; }
+
+				template<typename Promise>
+				void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+					PromiseBase &promise = handle.promise();
+					if (promise.finished.exchange(true, std::memory_order_acq_rel))
+						promise.continuation.resume();  // 等待者已挂起
+				}
+
+				void await_resume() const noexcept { }
+			};
+
+			std::suspend_always initial_suspend() const noexcept { return {}; }  // 惰性启动，被 co_await 时才开始执行
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+			void unhandled_exception() noexcept { this->exception = std::current_exception(); }
+		};
+
+
+		template<typename T>
+		struct Promise : PromiseBase {
+			std::optional<T> value;
+
+			task<T> get_return_object() noexcept;
+
+			template<typename U>
+			void return_value(U &&v) { this->value.emplace(std::forward<U>(v)); }
+
+			T result() {
+				if (this->exception)
+					std::rethrow_exception(this->exception);
+				return std::move(*this->value);
+			}
+		};
+
+
+		template<>
+		struct Promise<void> : PromiseBase {
+			task<void> get_return_object() noexcept;
+
+			void return_void() const noexcept { }
+
+			void result() {
+				if (this->exception)
+					std::rethrow_exception(this->exception);
+			}
+		};
+
+	}  // namespace coro_detail
+
+
+	// 只可移动；创建时不执行，被 co_await 时在等待者的线程中开始执行，结束后恢复等待者
+	// 每个 task 只能 co_await 一次；析构时销毁协程帧
+	template<typename T>
+	class task {
+	public:
+		using promise_type = coro_detail::Promise<T>;
+		using value_type = T;
+
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+
+		struct Awaiter {
+			std::coroutine_handle<promise_type> handle;
+
+			bool await_ready() const noexcept { return !this->handle || this->handle.done(); }
+
+			bool await_suspend(std::coroutine_handle<> caller) {
+				this->handle.promise().continuation = caller;
+				this->handle.resume();  // 开始执行本协程，直到结束或首次挂起
+				return !this->handle.promise().finished.exchange(true, std::memory_order_acq_rel);  // 已结束则不挂起
+			}
+
+			T await_resume() { return this->handle.promise().result(); }
+		};
+
+	public:
+		/* 构造函数 */
+		task() noexcept { }
+		explicit task(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) { }
+		task(task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) { }
+		task(const task &) = delete;
+
+		/* 析构函数 */
+		~task() {
+			if (this->m_handle)
+				this->m_handle.destroy();
+		}
+
+		/* 成员函数 */
+		task &operator=(task &&other) noexcept {
+			if (this != &other) {
+				if (this->m_handle)
+					this->m_handle.destroy();
+				this->m_handle = std::exchange(other.m_handle, nullptr);
+			}
+			return *this;
+		}
+		task &operator=(const task &) = delete;
+
+		bool valid() const noexcept { return (bool)this->m_handle; }  // 是否持有协程
+		bool done() const noexcept { return this->m_handle && this->m_handle.done(); }  // 是否已执行完
+
+		Awaiter operator co_await() const & noexcept { return Awaiter{ this->m_handle }; }
+		Awaiter operator co_await() const && noexcept { return Awaiter{ this->m_handle }; }
+	};
+
+
+	namespace coro_detail {
+
+		template<typename T>
+		task<T> Promise<T>::get_return_object() noexcept {
+			return task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+		}
+
+		inline task<void> Promise<void>::get_return_object() noexcept {
+			return task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+		}
+
+	}  // namespace coro_detail
+
+
+	/*
+	***************************在线程池中启动***************************
+	*/
+
+	namespace coro_detail {
+
+		// 立即启动、结束后自行销毁的协程，由 spawn 使用
+		struct Detached {
+			struct promise_type {
+				static void *operator new(size_t size) { return MemoryPool::allocate(size); }
+				static void operator delete(void *p, size_t size) { MemoryPool::deallocate(p, size); }
+
+				Detached get_return_object() const noexcept { return {}; }
+				std::suspend_never initial_suspend() const noexcept { return {}; }
+				std::suspend_never final_suspend() const noexcept { return {}; }
+				void return_void() const noexcept { }
+				void unhandled_exception() const noexcept { std::terminate(); }  // 异常已写入 future，不会到达这里
+			};
+		};
+
+		template<typename T>
+		Detached runSpawned(ThreadPool &pool, task<T> t, std::shared_ptr<future_detail::State<T>> state) {
+			try {
+				co_await pool.schedule();  // 线程池已关闭时抛出异常，同样写入 future
+				if constexpr (std::is_void<T>::value) {
+					co_await std::move(t);
+					state->setValue();
+				}
+				else {
+					state->setValue(co_await std::move(t));
+				}
+			}
+			catch (...) {
+				state->setException(std::current_exception());
+			}
+		}
+
+	}  // namespace coro_detail
+
+
+	/**
+	 * @description: 在线程池中启动协程，非协程代码通过返回的 future 等待结果 (也可以 then() 续延)
+	 * @param {ThreadPool} &pool: 线程池
+	 * @param {task<T>} t: 协程
+	 * @return {PoolFuture<T>} 协程的结果，协程抛出的异常在 get() 时重新抛出
+	 */
+	template<typename T>
+	PoolFuture<T> spawn(ThreadPool &pool, task<T> t) {
+		std::shared_ptr<future_detail::State<T>> state = future_detail::makeState<T>(&pool);
+		coro_detail::runSpawned(pool, std::move(t), state);
+		return PoolFuture<T>(state);
+	}
+
+}  // namespace coro
+
+
+/*
+***************************等待线程池 future***************************
+*/
+
+namespace coro {
+	namespace coro_detail {
+
+		// 挂起协程，future 就绪时由完成任务的线程恢复；已就绪时不挂起
+		template<typename T>
+		struct FutureAwaiter {
+			std::shared_ptr<future_detail::State<T>> state;
+
+			bool await_ready() const noexcept { return this->state->ready(); }
+
+			void await_suspend(std::coroutine_handle<> handle) {
+				// 回调可能立即恢复协程并销毁本等待体，先持有共享状态
+				std::shared_ptr<future_detail::State<T>> keep = this->state;
+				keep->addCallback(Task(Resume{ handle.address() }));
+			}
+
+			T await_resume() { return this->state->take(); }
+		};
+
+	}  // namespace coro_detail
+}  // namespace coro
+
+
+/**
+ * @description: co_await PoolFuture，等待期间不占用线程；之后 future 失效 (同 get())
+ * @param {PoolFuture<T>} &future: 线程池 future
+ * @return {FutureAwaiter<T>} 等待体，co_await 的结果为 future 的结果
+ */
+template<typename T>
+coro::coro_detail::FutureAwaiter<T> operator co_await(PoolFuture<T> &future) {
+	std::shared_ptr<future_detail::State<T>> state = future_detail::Access::state(future);
+	future = PoolFuture<T>();
+	return coro::coro_detail::FutureAwaiter<T>{ std::move(state) };
+}
+
+template<typename T>
+coro::coro_detail::FutureAwaiter<T> operator co_await(PoolFuture<T> &&future) {
+	return operator co_await(future);
+}
+
+#endif  // !POOL_COROUTINE_H__
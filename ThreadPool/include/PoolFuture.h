@@ -0,0 +1,604 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 17:26:51
+ * @last_edit_time: 2026-10-17 17:26:51
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/PoolFuture.h
+ * @description: 线程池原生的 future 头文件: 续延 then() 以及 when_all / when_any 组合
+ */
+
+#ifndef POOL_FUTURE_H__
+#define POOL_FUTURE_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "ThreadPool.h"
+
+template<typename T>
+class PoolFuture;
+
+/*
+***************************共享状态***************************
+*/
+
+// 与 std::future 的区别:
+//   1. 共享状态就绪时，由完成任务的线程依次执行登记的回调，续延因此无需任何线程阻塞等待
+//   2. 记录所属线程池，续延提交到同一个线程池；工作线程中等待结果时协作式等待
+//   3. 共享状态由线程私有的内存池分配
+namespace future_detail {
+
+	// 共享状态中与结果类型无关的部分
+	class StateBase {
+	protected:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::atomic<bool> m_ready;  // 结果 (或异常) 是否已写入
+		std::exception_ptr m_exception;  // 任务抛出的异常
+		std::vector<Task> m_callbacks;  // 就绪时由完成线程依次执行的回调
+
+		/**
+		 * @description: 标记就绪，唤醒等待者并执行回调，调用时持有 m_mutex
+		 * @param {unique_lock<mutex>} &lock: 已加锁的 m_mutex，返回前释放
+		 */
+		void publish(std::unique_lock<std::mutex> &lock) {
+			this->m_ready = true;
+			std::vector<Task> callbacks;
+			callbacks.swap(this->m_callbacks);
+			lock.unlock();
+
+			this->m_condition.notify_all();
+			for (Task &callback : callbacks)
+				callback();
+		}
+
+	public:
+		ThreadPool *const pool;  // 所属线程池，可能为空 (例如空集合上的 when_all)
+
+		explicit StateBase(ThreadPool *p) : m_ready(false), pool(p) { }
+		StateBase(const StateBase &) = delete;
+		StateBase &operator=(const StateBase &) = delete;
+
+		bool ready() const { return this->m_ready; }
+
+		/**
+		 * @description: 写入异常，已就绪时忽略
+		 * @param {exception_ptr} e: 异常
+		 */
+		void setException(std::exception_ptr e) {
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			if (this->m_ready)
+				return ;
+			this->m_exception = e;
+			this->publish(lock);
+		}
+
+		/**
+		 * @description: 登记就绪时执行的回调，已就绪时在当前线程立即执行；回调应当短小，不可阻塞
+		 * @param {Task} &&callback: 回调
+		 */
+		void addCallback(Task &&callback) {
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			if (!this->m_ready) {
+				this->m_callbacks.push_back(std::move(callback));
+				return ;
+			}
+			lock.unlock();
+			callback();
+		}
+
+		/**
+		 * @description: 等待就绪；在所属线程池的工作线程中调用时，等待期间执行其他任务
+		 */
+		void wait() {
+			if (this->m_ready)
+				return ;
+
+			if (this->pool != nullptr && this->pool->isWorkerThread()) {
+				this->pool->helpUntil([this]() { return this->ready(); });
+				return ;
+			}
+
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			this->m_condition.wait(lock, [this]() { return this->ready(); });
+		}
+
+		/**
+		 * @description: 限时等待就绪，不执行其他任务
+		 * @param {duration} timeout: 超时时长
+		 * @return {bool} 是否就绪
+		 */
+		template<typename Rep, typename Period>
+		bool waitFor(const std::chrono::duration<Rep, Period> &timeout) {
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			return this->m_condition.wait_for(lock, timeout, [this]() { return this->ready(); });
+		}
+	};
+
+
+	template<typename T>
+	class State : public StateBase {
+	private:
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;  // 结果，T 不要求可默认构造
+		bool m_has_value;
+
+	public:
+		explicit State(ThreadPool *p) : StateBase(p), m_has_value(false) { }
+		~State() {
+			if (this->m_has_value)
+				reinterpret_cast<T*>(&this->m_storage)->~T();
+		}
+
+		/**
+		 * @description: 写入结果，已就绪时忽略
+		 * @param {U} &&value: 结果
+		 */
+		template<typename U>
+		void setValue(U &&value) {
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			if (this->m_ready)
+				return ;
+			::new (&this->m_storage) T(std::forward<U>(value));
+			this->m_has_value = true;
+			this->publish(lock);
+		}
+
+		/**
+		 * @description: 取出结果，调用前必须已就绪；任务抛出的异常在此重新抛出
+		 * @return {T} 结果
+		 */
+		T take() {
+			if (this->m_exception)
+				std::rethrow_exception(this->m_exception);
+			return std::move(*reinterpret_cast<T*>(&this->m_storage));
+		}
+	};
+
+
+	template<>
+	class State<void> : public StateBase {
+	public:
+		explicit State(ThreadPool *p) : StateBase(p) { }
+
+		void setValue() {
+			std::unique_lock<std::mutex> lock(this->m_mutex);
+			if (this->m_ready)
+				return ;
+			this->publish(lock);
+		}
+
+		void take() {
+			if (this->m_exception)
+				std::rethrow_exception(this->m_exception);
+		}
+	};
+
+
+	/**
+	 * @description: 创建共享状态，由线程私有的内存池分配
+	 * @param {ThreadPool} *pool: 所属线程池
+	 * @return {shared_ptr<State<T>>} 共享状态
+	 */
+	template<typename T>
+	std::shared_ptr<State<T>> makeState(ThreadPool *pool) {
+		return std::allocate_shared<State<T>>(PoolAllocator<State<T>>(), pool);
+	}
+
+
+	// 调用 g() 并将结果写入共享状态
+	template<typename R>
+	struct Fulfil {
+		template<typename G>
+		static void run(State<R> &state, G &&g) { state.setValue(g()); }
+	};
+
+	template<>
+	struct Fulfil<void> {
+		template<typename G>
+		static void run(State<void> &state, G &&g) { g(); state.setValue(); }
+	};
+
+
+	// 以上一阶段的结果调用续延函数，上一阶段的异常在 take() 中重新抛出，续延函数不会被调用
+	template<typename T>
+	struct Apply {
+		template<typename F>
+		static auto call(F &f, State<T> &parent) -> decltype(f(parent.take())) { return f(parent.take()); }
+	};
+
+	template<>
+	struct Apply<void> {
+		template<typename F>
+		static auto call(F &f, State<void> &parent) -> decltype(f()) { parent.take(); return f(); }
+	};
+
+
+	// 续延函数的返回类型
+	template<typename F, typename T>
+	struct ThenResult {
+		using type = typename std::result_of<F(T)>::type;
+	};
+
+	template<typename F>
+	struct ThenResult<F, void> {
+		using type = typename std::result_of<F()>::type;
+	};
+
+
+	// 持有任务函数、参数以及共享状态，执行后将结果 (或异常) 写入共享状态
+	// 未执行就被销毁时 (提交超时) 写入 TaskAborted(REJECTED)
+	template<typename R, typename F, typename... Args>
+	class AsyncTask {
+	private:
+		std::shared_ptr<State<R>> m_state;
+		F m_func;  // 任务函数
+		std::tuple<Args...> m_args;  // 任务函数参数
+
+		template<size_t... I>
+		R call(IndexSequence<I...>) {
+			return this->m_func(unwrapArgument(std::get<I>(this->m_args))...);
+		}
+
+	public:
+		template<typename Fn, typename... As>
+		AsyncTask(const std::shared_ptr<State<R>> &state, Fn &&func, As &&... args)
+			: m_state(state)
+			, m_func(std::forward<Fn>(func))
+			, m_args(std::forward<As>(args)...)
+		{ }
+
+		AsyncTask(AsyncTask &&) = default;
+
+		~AsyncTask() {
+			if (this->m_state)
+				this->abort(TaskAbortReason::REJECTED);
+		}
+
+		void operator()() {
+			try {
+				Fulfil<R>::run(*this->m_state, [this]() -> R { return this->call(typename MakeIndexSequence<sizeof...(Args)>::type()); });
+			}
+			catch (...) {
+				this->m_state->setException(std::current_exception());
+			}
+			this->m_state.reset();
+		}
+
+		void abort(TaskAbortReason reason) {  // 不执行任务函数，future 得到 TaskAborted
+			this->m_state->setException(std::make_exception_ptr(TaskAborted(reason)));
+			this->m_state.reset();
+		}
+	};
+
+
+	// 上一阶段就绪后执行的续延
+	template<typename T, typename R, typename F>
+	class ThenTask {
+	private:
+		std::shared_ptr<State<T>> m_parent;  // 上一阶段
+		std::shared_ptr<State<R>> m_next;  // 本阶段
+		F m_func;  // 续延函数
+
+	public:
+		template<typename Fn>
+		ThenTask(const std::shared_ptr<State<T>> &parent, const std::shared_ptr<State<R>> &next, Fn &&func)
+			: m_parent(parent), m_next(next), m_func(std::forward<Fn>(func)) { }
+
+		void operator()() {
+			try {
+				Fulfil<R>::run(*this->m_next, [this]() -> R { return Apply<T>::call(this->m_func, *this->m_parent); });
+			}
+			catch (...) {
+				this->m_next->setException(std::current_exception());
+			}
+		}
+	};
+
+
+	// 登记在上一阶段上的回调: 将续延提交到线程池，任务队列已满或线程池已关闭时直接在当前线程执行
+	template<typename T, typename R, typename F>
+	class ScheduleThen {
+	private:
+		ThenTask<T, R, F> m_then;
+		ThreadPool *m_pool;
+
+	public:
+		ScheduleThen(ThenTask<T, R, F> &&then, ThreadPool *pool) : m_then(std::move(then)), m_pool(pool) { }
+
+		void operator()() {
+			Task task(std::move(this->m_then));
+			if (this->m_pool == nullptr || !this->m_pool->tryPost(task))
+				task();
+		}
+	};
+
+
+	// 组合函数访问 PoolFuture 的共享状态
+	struct Access {
+		template<typename Future>
+		static auto state(const Future &future) -> decltype(future.m_state) { return future.m_state; }
+	};
+
+
+	template<typename Future>
+	struct WhenAllState {
+		std::vector<Future> futures;
+		std::atomic<size_t> remaining;  // 尚未就绪的数量
+		std::shared_ptr<State<std::vector<Future>>> result;
+	};
+
+	template<typename Future>
+	struct WhenAllCallback {
+		std::shared_ptr<WhenAllState<Future>> shared;
+
+		void operator()() {
+			if (this->shared->remaining.fetch_sub(1) == 1)
+				this->shared->result->setValue(std::move(this->shared->futures));
+		}
+	};
+}
+
+
+/*
+***************************线程池 future***************************
+*/
+
+// 只可移动；get() 与 then() 都会取走共享状态，之后 valid() 为 false
+template<typename T>
+class PoolFuture {
+private:
+	std::shared_ptr<future_detail::State<T>> m_state;
+
+	friend struct future_detail::Access;
+
+public:
+	using value_type = T;
+
+	/* 构造函数 */
+	PoolFuture() { }
+	explicit PoolFuture(const std::shared_ptr<future_detail::State<T>> &state) : m_state(state) { }
+	PoolFuture(PoolFuture &&) = default;
+	PoolFuture(const PoolFuture &) = delete;
+
+	/* 成员函数 */
+	PoolFuture &operator=(PoolFuture &&) = default;
+	PoolFuture &operator=(const PoolFuture &) = delete;
+
+	bool valid() const { return (bool)this->m_state; }  // 是否持有共享状态
+	bool ready() const { return this->m_state->ready(); }  // 结果是否已就绪
+	void wait() const { this->m_state->wait(); }  // 等待就绪，工作线程中等待时执行其他任务
+
+	template<typename Rep, typename Period>
+	std::future_status wait_for(const std::chrono::duration<Rep, Period> &timeout) const;  // 限时等待，与 std::future 一致
+
+	T get();  // 等待并取出结果
+
+	template<typename F>
+	auto then(F &&f) -> PoolFuture<typename future_detail::ThenResult<typename std::decay<F>::type, T>::type>;  // 就绪后在线程池中执行 f(结果)
+};
+
+
+/**
+ * @description: 限时等待就绪，不执行其他任务
+ * @param {duration} timeout: 超时时长
+ * @return {std::future_status} ready/timeout
+ */
+template<typename T>
+template<typename Rep, typename Period>
+std::future_status PoolFuture<T>::wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+	return this->m_state->waitFor(timeout) ? std::future_status::ready : std::future_status::timeout;
+}
+
+
+/**
+ * @description: 等待并取出结果，之后 future 失效；任务抛出的异常在此重新抛出
+ * @return {T} 结果
+ */
+template<typename T>
+T PoolFuture<T>::get() {
+	std::shared_ptr<future_detail::State<T>> state = std::move(this->m_state);
+	state->wait();
+	return state->take();
+}
+
+
+/**
+ * @description: 登记续延，本 future 就绪后将 f 提交到同一个线程池执行，之后本 future 失效；
+ *               f 以本阶段的结果为参数 (void 时无参)，本阶段抛出异常时 f 不会被调用，异常传递给返回的 future
+ * @param {F} &&f: 续延函数
+ * @return {PoolFuture<R>} 续延函数的结果
+ */
+template<typename T>
+template<typename F>
+auto PoolFuture<T>::then(F &&f) -> PoolFuture<typename future_detail::ThenResult<typename std::decay<F>::type, T>::type> {
+	using func_type = typename std::decay<F>::type;
+	using result_type = typename future_detail::ThenResult<func_type, T>::type;
+
+	std::shared_ptr<future_detail::State<T>> parent = std::move(this->m_state);
+	std::shared_ptr<future_detail::State<result_type>> next = future_detail::makeState<result_type>(parent->pool);
+
+	future_detail::ThenTask<T, result_type, func_type> then(parent, next, std::forward<F>(f));
+	parent->addCallback(Task(future_detail::ScheduleThen<T, result_type, func_type>(std::move(then), parent->pool)));
+
+	return PoolFuture<result_type>(next);
+}
+
+
+/*
+***************************组合***************************
+*/
+
+// when_any 的结果: 最先就绪的 future 的下标以及全部 future
+template<typename Future>
+struct WhenAnyResult {
+	size_t index;  // 最先就绪的下标，集合为空时为 size_t(-1)
+	std::vector<Future> futures;
+};
+
+
+namespace future_detail {
+
+	template<typename Future>
+	struct WhenAnyState {
+		std::vector<Future> futures;
+		std::atomic<bool> done;  // 是否已有 future 就绪
+		std::shared_ptr<State<WhenAnyResult<Future>>> result;
+	};
+
+	template<typename Future>
+	struct WhenAnyCallback {
+		std::shared_ptr<WhenAnyState<Future>> shared;
+		size_t index;
+
+		void operator()() {
+			if (!this->shared->done.exchange(true)) {
+				WhenAnyResult<Future> result = { this->index, std::move(this->shared->futures) };
+				this->shared->result->setValue(std::move(result));
+			}
+		}
+	};
+
+
+	/**
+	 * @description: 取出全部共享状态，登记回调时不再访问可能已被回调移走的 futures
+	 */
+	template<typename Future>
+	std::vector<std::shared_ptr<StateBase>> statesOf(const std::vector<Future> &futures) {
+		std::vector<std::shared_ptr<StateBase>> states;
+		states.reserve(futures.size());
+		for (const Future &future : futures)
+			states.push_back(Access::state(future));
+		return states;
+	}
+}
+
+
+/**
+ * @description: 全部 future 就绪后就绪，不阻塞任何线程；区间中的 future 被移走
+ * @param {Iterator} first, last: PoolFuture 区间
+ * @return {PoolFuture<std::vector<Future>>} 全部 future (均已就绪)，各自的结果或异常通过 get() 取出
+ */
+template<typename Iterator>
+auto when_all(Iterator first, Iterator last) -> PoolFuture<std::vector<typename std::iterator_traits<Iterator>::value_type>> {
+	using future_type = typename std::iterator_traits<Iterator>::value_type;
+
+	std::shared_ptr<future_detail::WhenAllState<future_type>> shared = std::make_shared<future_detail::WhenAllState<future_type>>();
+	shared->futures.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+
+	ThreadPool *pool = shared->futures.empty() ? nullptr : future_detail::Access::state(shared->futures.front())->pool;
+	shared->result = future_detail::makeState<std::vector<future_type>>(pool);
+	PoolFuture<std::vector<future_type>> result(shared->result);
+
+	if (shared->futures.empty()) {
+		shared->result->setValue(std::vector<future_type>());
+		return result;
+	}
+
+	shared->remaining = shared->futures.size();
+	for (const std::shared_ptr<future_detail::StateBase> &state : future_detail::statesOf(shared->futures))
+		state->addCallback(Task(future_detail::WhenAllCallback<future_type>{ shared }));
+
+	return result;
+}
+
+
+/**
+ * @description: 任意一个 future 就绪后就绪，不阻塞任何线程；区间中的 future 被移走
+ * @param {Iterator} first, last: PoolFuture 区间
+ * @return {PoolFuture<WhenAnyResult<Future>>} 最先就绪的下标以及全部 future
+ */
+template<typename Iterator>
+auto when_any(Iterator first, Iterator last) -> PoolFuture<WhenAnyResult<typename std::iterator_traits<Iterator>::value_type>> {
+	using future_type = typename std::iterator_traits<Iterator>::value_type;
+
+	std::shared_ptr<future_detail::WhenAnyState<future_type>> shared = std::make_shared<future_detail::WhenAnyState<future_type>>();
+	shared->futures.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+	shared->done = false;
+
+	ThreadPool *pool = shared->futures.empty() ? nullptr : future_detail::Access::state(shared->futures.front())->pool;
+	shared->result = future_detail::makeState<WhenAnyResult<future_type>>(pool);
+	PoolFuture<WhenAnyResult<future_type>> result(shared->result);
+
+	if (shared->futures.empty()) {
+		WhenAnyResult<future_type> empty = { size_t(-1), std::vector<future_type>() };
+		shared->result->setValue(std::move(empty));
+		return result;
+	}
+
+	std::vector<std::shared_ptr<future_detail::StateBase>> states = future_detail::statesOf(shared->futures);
+	for (size_t i = 0; i < states.size(); ++i)
+		states[i]->addCallback(Task(future_detail::WhenAnyCallback<future_type>{ shared, i }));
+
+	return result;
+}
+
+
+/**
+ * @description: when_all / when_any 的容器版本，容器中的 future 被移走
+ */
+template<typename Future>
+auto when_all(std::vector<Future> &futures) -> decltype(when_all(futures.begin(), futures.end())) {
+	return when_all(futures.begin(), futures.end());
+}
+
+template<typename Future>
+auto when_any(std::vector<Future> &futures) -> decltype(when_any(futures.begin(), futures.end())) {
+	return when_any(futures.begin(), futures.end());
+}
+
+
+/*
+***************************提交任务***************************
+*/
+
+/**
+ * @description: 提交异步执行的函数，返回线程池 future，可通过 then() 继续串联后续阶段
+ * @param {F} &&f: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {PoolFuture<decltype(f(args...))>} 任务函数形成的 future，提交超时时为 TaskAborted(REJECTED)
+ */
+template <typename F, typename... Args>
+auto ThreadPool::async(F &&f, Args &&... args) -> PoolFuture<decltype(f(args...))> {
+	using func_return_type = typename std::result_of<F(Args...)>::type;
+	using async_task_type = future_detail::AsyncTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+	std::shared_ptr<future_detail::State<func_return_type>> state = future_detail::makeState<func_return_type>(this);
+
+	Task task(async_task_type(state, std::forward<F>(f), std::forward<Args>(args)...));
+
+	// 任务入队，提交超时时任务在此析构，future 得到 TaskAborted(REJECTED)
+	this->enqueueTask(task);
+
+	return PoolFuture<func_return_type>(state);
+}
+
+
+/**
+ * @description: 提交带选项的异步执行函数，返回线程池 future
+ * @param {TaskOptions} &options: 提交选项，任务执行前已取消或已过期时不执行，future 得到 TaskAborted
+ * @param {F} &&f: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {PoolFuture<decltype(f(args...))>} 任务函数形成的 future
+ */
+template <typename F, typename... Args>
+auto ThreadPool::async(const TaskOptions &options, F &&f, Args &&... args) -> PoolFuture<decltype(f(args...))> {
+	using func_return_type = typename std::result_of<F(Args...)>::type;
+	using async_task_type = future_detail::AsyncTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+	std::shared_ptr<future_detail::State<func_return_type>> state = future_detail::makeState<func_return_type>(this);
+
+	this->enqueueGuarded(options, async_task_type(state, std::forward<F>(f), std::forward<Args>(args)...));
+
+	return PoolFuture<func_return_type>(state);
+}
+
+#endif  // !POOL_FUTURE_H__
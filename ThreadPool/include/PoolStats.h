@@ -0,0 +1,197 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 00:12:37
+ * @last_edit_time: 2026-10-18 00:12:37
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/PoolStats.h
+ * @description: 线程池运行统计头文件: 工作线程私有的计数器、排队时间与执行时间直方图
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+/*
+***************************统计快照***************************
+*/
+
+static const size_t STATS_BUCKETS = 40;  // 直方图桶数，第 i 个桶为 [2^i, 2^(i+1)) 纳秒 (最长约 18 分钟)，第 0 个桶含 0，最后一个桶含更长的时间
+
+// ThreadPool::stats() 的返回值，各计数器分别读取，彼此之间不保证是同一时刻的值
+struct ThreadPoolStats {
+	uint64_t submitted;  // 提交成功的任务数量
+	uint64_t executed;  // 执行完的任务数量
+	uint64_t stolen;  // 从其他线程的私有队列窃取的任务数量
+	uint64_t rejected;  // 线程池已关闭而被拒绝的任务数量
+	uint64_t timed_out;  // 任务队列已满且等待超时而提交失败的任务数量
+	uint64_t queue_wait_ns;  // 排队时间总和 (纳秒)
+	uint64_t run_time_ns;  // 执行时间总和 (纳秒)
+	uint64_t queue_wait[STATS_BUCKETS];  // 排队时间直方图
+	uint64_t run_time[STATS_BUCKETS];  // 执行时间直方图
+
+	ThreadPoolStats() { std::memset(this, 0, sizeof(*this)); }
+
+	/**
+	 * @description: 由直方图估计分位数
+	 * @param {uint64_t} (&histogram)[STATS_BUCKETS]: queue_wait 或 run_time
+	 * @param {double} p: 分位，如 0.99
+	 * @return {uint64_t} 分位数所在桶的上界 (纳秒)，没有样本时为 0
+	 */
+	static uint64_t percentile(const uint64_t (&histogram)[STATS_BUCKETS], double p) {
+		uint64_t total = 0;
+		for (size_t i = 0; i < STATS_BUCKETS; ++i)
+			total += histogram[i];
+		if (total == 0)
+			return 0;
+
+		uint64_t rank = (uint64_t)(p * (double)total);
+		uint64_t seen = 0;
+		for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+			seen += histogram[i];
+			if (seen > rank)
+				return (uint64_t)1 << (i + 1);
+		}
+		return (uint64_t)1 << STATS_BUCKETS;
+	}
+};
+
+
+/*
+***************************统计计数器***************************
+*/
+
+// 当前时间 (纳秒)，用于排队时间与执行时间
+inline uint64_t statsClock() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// 每个工作线程一份，放在线程自己的栈上，前后各留一个缓存行，不与其他线程的数据共享缓存行
+// 只有所属线程写入，计数只需普通的读与写 (不用原子加)；stats() 从其他线程按 relaxed 读取
+// 非工作线程共用一份 (shared)，此时改用原子加
+class StatsCounters {
+public:
+	static const size_t CACHE_LINE = 64;
+
+	explicit StatsCounters(bool shared = false) : m_shared(shared) {
+		for (std::atomic<uint64_t> *c : { &m_submitted, &m_executed, &m_stolen, &m_rejected, &m_timed_out, &m_queue_wait_ns, &m_run_time_ns })
+			c->store(0, std::memory_order_relaxed);
+		for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+			this->m_queue_wait[i].store(0, std::memory_order_relaxed);
+			this->m_run_time[i].store(0, std::memory_order_relaxed);
+		}
+	}
+	StatsCounters(const StatsCounters &) = delete;
+	StatsCounters &operator=(const StatsCounters &) = delete;
+
+	void submitted(uint64_t n) { this->add(this->m_submitted, n); }
+	void stolen() { this->add(this->m_stolen, 1); }
+	void rejected(uint64_t n) { this->add(this->m_rejected, n); }
+	void timedOut(uint64_t n) { this->add(this->m_timed_out, n); }
+
+	/**
+	 * @description: 记录一个执行完的任务
+	 * @param {uint64_t} wait: 排队时间 (纳秒)
+	 * @param {uint64_t} run: 执行时间 (纳秒)
+	 */
+	void executed(uint64_t wait, uint64_t run) {
+		this->add(this->m_executed, 1);
+		this->add(this->m_queue_wait_ns, wait);
+		this->add(this->m_run_time_ns, run);
+		this->add(this->m_queue_wait[bucketOf(wait)], 1);
+		this->add(this->m_run_time[bucketOf(run)], 1);
+	}
+
+	/**
+	 * @description: 累加到快照中
+	 * @param {ThreadPoolStats} &stats: 快照
+	 */
+	void addTo(ThreadPoolStats &stats) const {
+		stats.submitted += this->m_submitted.load(std::memory_order_relaxed);
+		stats.executed += this->m_executed.load(std::memory_order_relaxed);
+		stats.stolen += this->m_stolen.load(std::memory_order_relaxed);
+		stats.rejected += this->m_rejected.load(std::memory_order_relaxed);
+		stats.timed_out += this->m_timed_out.load(std::memory_order_relaxed);
+		stats.queue_wait_ns += this->m_queue_wait_ns.load(std::memory_order_relaxed);
+		stats.run_time_ns += this->m_run_time_ns.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+			stats.queue_wait[i] += this->m_queue_wait[i].load(std::memory_order_relaxed);
+			stats.run_time[i] += this->m_run_time[i].load(std::memory_order_relaxed);
+		}
+	}
+
+private:
+	char m_pad_front[CACHE_LINE];  // 与前面的数据隔开
+	bool m_shared;  // 是否由多个线程共同写入
+	std::atomic<uint64_t> m_submitted;
+	std::atomic<uint64_t> m_executed;
+	std::atomic<uint64_t> m_stolen;
+	std::atomic<uint64_t> m_rejected;
+	std::atomic<uint64_t> m_timed_out;
+	std::atomic<uint64_t> m_queue_wait_ns;
+	std::atomic<uint64_t> m_run_time_ns;
+	std::atomic<uint64_t> m_queue_wait[STATS_BUCKETS];
+	std::atomic<uint64_t> m_run_time[STATS_BUCKETS];
+	char m_pad_back[CACHE_LINE];  // 与后面的数据隔开
+
+	void add(std::atomic<uint64_t> &counter, uint64_t n) {
+		if (this->m_shared)
+			counter.fetch_add(n, std::memory_order_relaxed);
+		else
+			counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	static size_t bucketOf(uint64_t ns) {
+		size_t bucket = ns > 1 ? 63 - (size_t)__builtin_clzll(ns) : 0;  // 最高位
+		return bucket < STATS_BUCKETS ? bucket : STATS_BUCKETS - 1;
+	}
+};
+
+
+/*
+***************************统计汇总***************************
+*/
+
+// 登记存活工作线程的计数器；线程退出时把它的计数并入 m_retired，快照时加上所有存活线程的当前值
+// 工作线程只在启动和退出时加锁，执行任务时不访问这里
+class StatsRegistry {
+public:
+	StatsRegistry() : m_external(true) { }
+
+	StatsCounters &external() { return this->m_external; }  // 非工作线程共用的计数器
+
+	void attach(const StatsCounters *counters) {
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+		this->m_live.push_back(counters);
+	}
+
+	void detach(const StatsCounters *counters) {
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+		std::vector<const StatsCounters*>::iterator it = std::find(this->m_live.begin(), this->m_live.end(), counters);
+		if (it != this->m_live.end()) {
+			counters->addTo(this->m_retired);
+			this->m_live.erase(it);
+		}
+	}
+
+	ThreadPoolStats snapshot() {
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+		ThreadPoolStats stats = this->m_retired;
+		for (const StatsCounters *counters : this->m_live)
+			counters->addTo(stats);
+		this->m_external.addTo(stats);
+		return stats;
+	}
+
+private:
+	std::mutex m_mutex;  // 保护 m_live 与 m_retired
+	std::vector<const StatsCounters*> m_live;  // 存活工作线程的计数器
+	ThreadPoolStats m_retired;  // 已退出线程的计数
+	StatsCounters m_external;  // 非工作线程共用的计数器
+};
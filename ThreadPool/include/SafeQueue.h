@@ -5,79 +5,155 @@
  * @date: 2023-03-14 10:19:29
  * @last_edit_time: 2023-03-14 13:50:55
  * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/SafeQueue.h
- * @description: 线程池任务队列头文件
+ * @description: 线程池任务队列头文件，分桶优先级队列
  */
 
 #pragma once
-#include <queue>
+#include <cstdint>
+#include <deque>
 #include <mutex>
-
+#include <utility>
+#include "TaskQueue.h"
+
+/*
+***************************分桶优先级队列***************************
+*/
+
+// 固定 LEVELS 个优先级，每个优先级一个先进先出的桶，位图记录非空的桶:
+//   入队: 放入对应桶的队尾，O(1)
+//   出队: 位图最高位即最高的非空优先级，取其队首，O(1)；同一优先级严格按入队顺序
+//   老化 (可选): 每 aging 次出队中有一次改为取出等待最久的任务 (各桶队首中序号最小者)，
+//               持续涌入高优先级任务时，低优先级任务仍能在有限时间内被执行
 template<typename T>
-class SafeQueue {
+class SafeQueue : public TaskQueue<T> {
+public:
+	static const size_t LEVELS = 64;  // 优先级数量，超过 LEVELS - 1 的优先级按 LEVELS - 1 处理
+
 private:
-	// 优先级队列，比较函数
-	struct cmp {  
-		bool operator()(std::pair<T, size_t>& a, std::pair<T, size_t>& b){
-			return a.second < b.second;
-		}
-	};
-	
-	std::priority_queue<std::pair<T, size_t>, std::vector<std::pair<T, size_t>>, cmp> m_safe_queue;  // 任务队列
+	std::deque<std::pair<T, uint64_t>> m_buckets[LEVELS];  // 各优先级的桶，元素为 (任务, 入队序号)
+	uint64_t m_bitmap;  // 第 i 位表示优先级 i 的桶非空
+	uint64_t m_sequence;  // 下一个入队序号
+	size_t m_size;  // 任务数量
+	size_t m_capacity;  // 容量，达到后入队失败
+	size_t m_aging;  // 老化间隔，0 表示不启用
+	size_t m_dequeues;  // 距上一次老化出队的出队次数
 	std::mutex m_safe_queue_mutex;  // 任务队列互斥锁
 
+	static size_t levelOf(size_t priority) { return priority < LEVELS ? priority : LEVELS - 1; }
+	void push(T &t, size_t level);  // 放入桶的队尾，调用时持有锁
+	size_t oldestLevel() const;  // 队首任务等待最久的优先级，调用时持有锁
+
 public:
 	/* 构造函数 */
-	SafeQueue() { }
+	SafeQueue() : m_bitmap(0), m_sequence(0), m_size(0), m_capacity(SIZE_MAX), m_aging(0), m_dequeues(0) { }
 
 	/* 析构函数 */
 	~SafeQueue() { }
 
 	/* 成员函数 */
-	bool empty();  // 队列是否为空
-	size_t safeQueueSize();  // 任务队列大小
-	void taskEnqueue(T &, size_t);  // 添加任务
-	bool taskDequeue(T &);  // 取出任务
+	bool empty() override;  // 队列是否为空
+	size_t safeQueueSize() override;  // 任务队列大小
+	bool taskEnqueue(T &, size_t) override;  // 添加任务
+	size_t taskEnqueueBatch(T *, size_t, size_t) override;  // 批量添加任务
+	bool taskDequeue(T &) override;  // 取出任务
+	bool setCapacity(size_t) override;  // 设置容量
+	void setAging(size_t) override;  // 设置老化间隔
 };
 
 
 /**
  * @description: 判断任务队列是否为空
- * @return {bool} this->m_safe_queue.empty()
+ * @return {bool} this->m_size == 0
  */
 template<typename T>
 bool SafeQueue<T>::empty() {
 	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);  // 任务队列上锁
 
-	return this->m_safe_queue.empty();
+	return this->m_size == 0;
 }
 
 
 /**
  * @description: 获取任务队列大小
- * @return {size_t} this->m_safe_queue.size()
+ * @return {size_t} this->m_size
  */
 template<typename T>
 size_t SafeQueue<T>::safeQueueSize() {
 	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);  // 任务队列上锁
 
-	return this->m_safe_queue.size();
+	return this->m_size;
+}
+
+
+/**
+ * @description: 放入对应优先级的桶的队尾，并记录入队序号
+ * @param {T} &t: 任务函数，放入后被移走
+ * @param {size_t} level: 优先级
+ */
+template<typename T>
+void SafeQueue<T>::push(T &t, size_t level) {
+	this->m_buckets[level].emplace_back(std::move(t), this->m_sequence++);
+	this->m_bitmap |= (uint64_t)1 << level;
+	++this->m_size;
+}
+
+
+/**
+ * @description: 各桶队首中入队序号最小者所在的优先级，即等待最久的任务
+ * @return {size_t} 优先级，调用前队列非空
+ */
+template<typename T>
+size_t SafeQueue<T>::oldestLevel() const {
+	size_t oldest = LEVELS;
+	for (uint64_t bits = this->m_bitmap; bits != 0; bits &= bits - 1) {
+		size_t level = (size_t)__builtin_ctzll(bits);
+		if (oldest == LEVELS || this->m_buckets[level].front().second < this->m_buckets[oldest].front().second)
+			oldest = level;
+	}
+	return oldest;
+}
+
+
+/**
+ * @description: 向任务队列添加任务，容量检查与入队在同一次加锁中完成，并发提交不会超过容量
+ * @param {T} t: 任务函数，成功入队后被移走
+ * @param {size_t} priority: 任务优先级
+ * @return {bool} 队列已满时返回 false
+ */
+template<typename T>
+bool SafeQueue<T>::taskEnqueue(T &t, size_t priority) {
+	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);
+
+	if (this->m_size >= this->m_capacity)
+		return false;
+
+	this->push(t, SafeQueue::levelOf(priority));
+
+	return true;
 }
 
 
 /**
- * @description: 向任务队列添加任务
- * @param {T} t: 任务函数
+ * @description: 批量向任务队列添加任务，只加锁一次
+ * @param {T} *tasks: 任务数组，入队的部分被移走
+ * @param {size_t} n: 任务数量
  * @param {size_t} priority: 任务优先级
+ * @return {size_t} 实际入队的数量，队列剩余空间不足时只入队前一部分
  */
 template<typename T>
-void SafeQueue<T>::taskEnqueue(T &t, size_t priority) {
+size_t SafeQueue<T>::taskEnqueueBatch(T *tasks, size_t n, size_t priority) {
 	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);
 
-	std::pair<T, int> priority_task(t, priority);
+	size_t room = this->m_size < this->m_capacity ? this->m_capacity - this->m_size : 0;
+	if (n > room)
+		n = room;
 
-	this->m_safe_queue.emplace(priority_task);
+	size_t level = SafeQueue::levelOf(priority);
+	for (size_t i = 0; i < n; ++i) {
+		this->push(tasks[i], level);
+	}
 
-	std::cout << "任务已提交，当前任务数量为: " << this->m_safe_queue.size() << std::endl;
+	return n;
 }
 
 
@@ -90,11 +166,51 @@ template<typename T>
 bool SafeQueue<T>::taskDequeue(T &t) {
 	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);  // 任务队列上锁
 
-	if (this->m_safe_queue.empty())
+	if (this->m_size == 0)
 		return false;
 
-	t = std::move(this->m_safe_queue.top().first);  // 取出队首元素，返回队首元素值，并进行右值引用
-	this->m_safe_queue.pop();  // 弹出入队的第一个元素
+	size_t level = 63 - (size_t)__builtin_clzll(this->m_bitmap);  // 最高的非空优先级
+
+	// 老化: 每 m_aging 次出队中有一次取出等待最久的任务
+	if (this->m_aging != 0 && ++this->m_dequeues >= this->m_aging) {
+		this->m_dequeues = 0;
+		level = this->oldestLevel();
+	}
+
+	std::deque<std::pair<T, uint64_t>> &bucket = this->m_buckets[level];
+	t = std::move(bucket.front().first);
+	bucket.pop_front();
+	if (bucket.empty())
+		this->m_bitmap &= ~((uint64_t)1 << level);
+	--this->m_size;
 
 	return true;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @description: 设置容量，已在队列中的任务不受影响
+ * @param {size_t} capacity: 容量
+ * @return {bool} true
+ */
+template<typename T>
+bool SafeQueue<T>::setCapacity(size_t capacity) {
+	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);
+
+	this->m_capacity = capacity;
+
+	return true;
+}
+
+
+/**
+ * @description: 设置老化间隔
+ * @param {size_t} aging: 每 aging 次出队中有一次取出等待最久的任务，0 表示严格按优先级
+ */
+template<typename T>
+void SafeQueue<T>::setAging(size_t aging) {
+	std::unique_lock<std::mutex> lock(this->m_safe_queue_mutex);
+
+	this->m_aging = aging;
+	this->m_dequeues = 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 22:51:13
+ * @last_edit_time: 2026-10-17 22:51:13
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/Strand.h
+ * @description: 串行执行器头文件: 同一个 strand 上的任务按提交顺序逐个执行，不同 strand 之间并行
+ */
+
+#ifndef STRAND_H__
+#define STRAND_H__
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+
+/*
+***************************串行执行器的共享状态***************************
+*/
+
+namespace strand_detail {
+
+	static const size_t BATCH = 64;  // 一次最多连续执行的任务数量，之后重新排队，让出工作线程
+
+	struct State {
+		ThreadPool &pool;  // 执行任务的线程池
+		std::mutex mutex;  // 只保护任务队列，执行任务时不持有
+		std::deque<Task> queue;  // 尚未执行的任务
+		bool scheduled;  // 线程池中是否已有 (或正在执行) 本 strand 的执行任务
+
+		explicit State(ThreadPool &p) : pool(p), scheduled(false) { }
+	};
+
+	// 当前线程正在执行的 strand
+	inline State *&current() {
+		static thread_local State *state = nullptr;
+		return state;
+	}
+
+	// 提交到线程池的执行任务: 依次取出并执行 strand 队列中的任务，任意时刻每个 strand 最多只有一个
+	struct Drain {
+		std::shared_ptr<State> state;
+
+		void operator()() {
+			State *outer = current();
+			current() = this->state.get();
+
+			for (size_t executed = 0; ; ++executed) {
+				Task task;
+				{
+					std::unique_lock<std::mutex> lock(this->state->mutex);
+					if (this->state->queue.empty()) {
+						this->state->scheduled = false;
+						break;
+					}
+
+					// 连续执行了一批，重新排到线程池队尾，其他任务 (和其他 strand) 不会被饿死
+					if (executed == BATCH) {
+						lock.unlock();
+						Task next(Drain{ this->state });
+						if (this->state->pool.tryPost(next)) {
+							break;
+						}
+						executed = 0;  // 任务队列已满，继续在当前线程执行
+						lock.lock();
+					}
+
+					task = std::move(this->state->queue.front());
+					this->state->queue.pop_front();
+				}
+				task();  // 任务自行捕获异常
+			}
+
+			current() = outer;
+		}
+	};
+
+	/**
+	 * @description: 任务加入 strand 队列；strand 空闲时将执行任务提交到线程池
+	 *               提交超时时在当前线程执行队列中的任务，已加入队列的任务不会丢失
+	 *               线程池已关闭时与 ThreadPool::post 一致抛出异常，只拒绝本任务，其他线程期间加入的任务仍在当前线程执行
+	 * @param {shared_ptr<State>} &state: strand 的共享状态
+	 * @param {Task} &&task: 任务
+	 * @return {bool} true
+	 */
+	inline bool dispatch(const std::shared_ptr<State> &state, Task &&task) {
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->queue.push_back(std::move(task));
+			if (state->scheduled) {
+				return true;
+			}
+			state->scheduled = true;  // 此前队列为空，本任务位于队首
+		}
+
+		bool posted;
+		try {
+			posted = state->pool.post(Drain{ state });
+		}
+		catch (...) {
+			Task rejected;  // 在锁外析构，promise 在析构时写入 TaskAborted(REJECTED)
+			bool remaining;
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				rejected = std::move(state->queue.front());
+				state->queue.pop_front();
+				remaining = !state->queue.empty();
+				state->scheduled = remaining;
+			}
+			if (remaining) {
+				Drain{ state }();
+			}
+			throw;
+		}
+
+		if (!posted) {
+			Drain{ state }();  // 任务队列已满且等待超时，与 Drain 让出失败时一样在当前线程执行
+		}
+		return true;
+	}
+
+}  // namespace strand_detail
+
+
+/*
+***************************串行执行器***************************
+*/
+
+// 用法: Strand strand(pool); strand.post(handle, conn); strand.submitTask(func, args...);
+// 同一个 strand 上的任务按提交顺序逐个执行 (可能在不同的工作线程上)，前一个任务的写入对后一个任务可见，
+// 因此按连接、按账户等建立 strand 后，无需再为每个实体加锁；不同 strand 的任务仍然并行执行
+// 可复制，副本共享同一个任务队列；strand 析构后尚未执行的任务仍会执行
+class Strand {
+private:
+	std::shared_ptr<strand_detail::State> m_state;
+
+public:
+	explicit Strand(ThreadPool &pool) : m_state(std::make_shared<strand_detail::State>(pool)) { }
+
+	/**
+	 * @description: 提交任务，返回 std::future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {std::future<decltype(f(args...))>} 任务函数形成的 future，线程池已关闭时抛出异常
+	 */
+	template <typename F, typename... Args>
+	auto submitTask(F &&f, Args &&...args) -> std::future<decltype(f(args...))> {
+		using func_return_type = typename std::result_of<F(Args...)>::type;
+		using promise_task_type = PromiseTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		std::promise<func_return_type> promise(std::allocator_arg, PoolAllocator<char>());
+		auto return_future = promise.get_future();
+
+		strand_detail::dispatch(this->m_state, Task(promise_task_type(std::move(promise), std::forward<F>(f), std::forward<Args>(args)...)));
+
+		return return_future;
+	}
+
+	/**
+	 * @description: 提交任务，不返回 future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {bool} true，线程池已关闭时抛出异常
+	 */
+	template <typename F, typename... Args>
+	bool post(F &&f, Args &&...args) {
+		using detached_task_type = DetachedTask<typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		return strand_detail::dispatch(this->m_state, Task(detached_task_type(std::forward<F>(f), std::forward<Args>(args)...)));
+	}
+
+	/**
+	 * @description: 提交任务，返回线程池 future
+	 * @param {F} &&f: 任务函数
+	 * @param {Args &&...} args: 任务函数参数
+	 * @return {PoolFuture<decltype(f(args...))>} 任务函数形成的 future
+	 */
+	template <typename F, typename... Args>
+	auto async(F &&f, Args &&...args) -> PoolFuture<decltype(f(args...))> {
+		using func_return_type = typename std::result_of<F(Args...)>::type;
+		using async_task_type = future_detail::AsyncTask<func_return_type, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+		std::shared_ptr<future_detail::State<func_return_type>> state = future_detail::makeState<func_return_type>(&this->m_state->pool);
+
+		strand_detail::dispatch(this->m_state, Task(async_task_type(state, std::forward<F>(f), std::forward<Args>(args)...)));
+
+		return PoolFuture<func_return_type>(state);
+	}
+
+	/**
+	 * @description: 当前线程是否正在执行本 strand 的任务
+	 * @return {bool} true/false
+	 */
+	bool runningInThisThread() const {
+		return strand_detail::current() == this->m_state.get();
+	}
+
+	/**
+	 * @description: 获取尚未执行的任务数量
+	 * @return {size_t} 任务数量
+	 */
+	size_t getPendingTasksAmount() const {
+		std::unique_lock<std::mutex> lock(this->m_state->mutex);
+		return this->m_state->queue.size();
+	}
+};
+
+#endif  // !STRAND_H__
@@ -0,0 +1,183 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:20:05
+ * @last_edit_time: 2026-10-17 11:20:05
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/Task.h
+ * @description: 线程池任务类型头文件，只可移动、带内联存储的无参无返回值函数
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/*
+***************************任务***************************
+*/
+
+// 与 std::function<void()> 的区别:
+//   1. 只可移动，因此可以直接持有 std::promise 等只可移动的对象，无需 shared_ptr 包装
+//   2. 不超过 INLINE_SIZE 字节的可调用对象直接存放在对象内部，不申请堆内存
+class Task {
+public:
+	static const size_t INLINE_SIZE = 64;  // 内联存储大小
+
+private:
+	/* 类型擦除后的操作表，每种可调用对象类型一份 */
+	struct Operations {
+		void (*invoke)(void *);  // 调用
+		void (*move)(void *, void *);  // 移动到另一块存储 (目标, 源)，并析构源
+		void (*destroy)(void *);  // 析构
+	};
+
+	template<typename F>
+	struct InlineOperations {  // 可调用对象存放在内联存储中
+		static void invoke(void *p) { (*static_cast<F*>(p))(); }
+		static void move(void *dst, void *src) { ::new (dst) F(std::move(*static_cast<F*>(src))); static_cast<F*>(src)->~F(); }
+		static void destroy(void *p) { static_cast<F*>(p)->~F(); }
+		static const Operations table;
+	};
+
+	template<typename F>
+	struct HeapOperations {  // 可调用对象过大，内联存储中只存放指针
+		static void invoke(void *p) { (**static_cast<F**>(p))(); }
+		static void move(void *dst, void *src) { *static_cast<F**>(dst) = *static_cast<F**>(src); }
+		static void destroy(void *p) { delete *static_cast<F**>(p); }
+		static const Operations table;
+	};
+
+	template<typename F>
+	struct FitsInline {
+		static const bool value = sizeof(F) <= INLINE_SIZE
+			&& alignof(F) <= alignof(std::max_align_t)
+			&& std::is_nothrow_move_constructible<F>::value;
+	};
+
+	typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type m_storage;  // 内联存储
+	const Operations *m_operations;  // 为空表示没有任务
+	uint64_t m_enqueued;  // 入队时刻 (纳秒)，用于统计排队时间，0 表示未记录
+
+	void reset();  // 析构当前持有的可调用对象
+
+	template<typename Func, typename F>
+	void construct(F &&f, std::true_type);  // 存放在内联存储中
+
+	template<typename Func, typename F>
+	void construct(F &&f, std::false_type);  // 存放在堆上
+
+public:
+	/* 构造函数 */
+	Task() : m_operations(nullptr), m_enqueued(0) { }
+	Task(std::nullptr_t) : m_operations(nullptr), m_enqueued(0) { }
+
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+	Task(F &&f);  // 包装任意无参可调用对象
+
+	Task(Task &&other) noexcept;  // 移动构造函数
+	Task(const Task &) = delete;  // 删除拷贝构造函数
+
+	/* 析构函数 */
+	~Task() { this->reset(); }
+
+	/* 成员函数 */
+	Task &operator=(Task &&other) noexcept;  // 移动赋值运算符
+	Task &operator=(const Task &) = delete;  // 删除赋值构造函数
+	Task &operator=(std::nullptr_t) { this->reset(); return *this; }  // 释放任务
+
+	void operator()() { this->m_operations->invoke(&this->m_storage); }  // 执行任务
+	explicit operator bool() const { return this->m_operations != nullptr; }  // 是否持有任务
+
+	void stamp(uint64_t t) { this->m_enqueued = t; }  // 记录入队时刻
+	uint64_t stamped() const { return this->m_enqueued; }  // 入队时刻，0 表示未记录
+};
+
+
+template<typename F>
+const Task::Operations Task::InlineOperations<F>::table = {
+	&Task::InlineOperations<F>::invoke, &Task::InlineOperations<F>::move, &Task::InlineOperations<F>::destroy
+};
+
+template<typename F>
+const Task::Operations Task::HeapOperations<F>::table = {
+	&Task::HeapOperations<F>::invoke, &Task::HeapOperations<F>::move, &Task::HeapOperations<F>::destroy
+};
+
+
+/**
+ * @description: 包装任意无参可调用对象，足够小时存放在内联存储中
+ * @param {F} &&f: 可调用对象
+ */
+template<typename F, typename>
+Task::Task(F &&f) : m_enqueued(0) {
+	using Func = typename std::decay<F>::type;
+
+	this->construct<Func>(std::forward<F>(f), std::integral_constant<bool, FitsInline<Func>::value>());
+}
+
+
+/**
+ * @description: 将可调用对象存放在内联存储中
+ * @param {F} &&f: 可调用对象
+ */
+template<typename Func, typename F>
+void Task::construct(F &&f, std::true_type) {
+	::new (&this->m_storage) Func(std::forward<F>(f));
+	this->m_operations = &InlineOperations<Func>::table;
+}
+
+
+/**
+ * @description: 可调用对象过大，存放在堆上，内联存储中只保存指针
+ * @param {F} &&f: 可调用对象
+ */
+template<typename Func, typename F>
+void Task::construct(F &&f, std::false_type) {
+	*reinterpret_cast<Func**>(&this->m_storage) = new Func(std::forward<F>(f));
+	this->m_operations = &HeapOperations<Func>::table;
+}
+
+
+/**
+ * @description: 移动构造函数
+ * @param {Task} &&other: 被移动的任务，移动后为空
+ */
+inline Task::Task(Task &&other) noexcept : m_operations(other.m_operations), m_enqueued(other.m_enqueued) {
+	if (this->m_operations) {
+		this->m_operations->move(&this->m_storage, &other.m_storage);
+		other.m_operations = nullptr;
+	}
+}
+
+
+/**
+ * @description: 移动赋值运算符
+ * @param {Task} &&other: 被移动的任务，移动后为空
+ * @return {Task &} *this
+ */
+inline Task &Task::operator=(Task &&other) noexcept {
+	if (this != &other) {
+		this->reset();
+		if (other.m_operations) {
+			other.m_operations->move(&this->m_storage, &other.m_storage);
+			this->m_operations = other.m_operations;
+			other.m_operations = nullptr;
+		}
+		this->m_enqueued = other.m_enqueued;
+	}
+	return *this;
+}
+
+
+/**
+ * @description: 析构当前持有的可调用对象
+ */
+inline void Task::reset() {
+	if (this->m_operations) {
+		this->m_operations->destroy(&this->m_storage);
+		this->m_operations = nullptr;
+	}
+}
@@ -0,0 +1,113 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 22:18:40
+ * @last_edit_time: 2026-10-17 22:18:40
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/TaskArena.h
+ * @description: 工作线程私有的线性分配内存区头文件，任务内的临时内存随任务结束整体回收
+ */
+
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+***************************任务内存区***************************
+*/
+
+// 每个工作线程拥有一个内存区，任务通过 TaskArena::current() 取得:
+//   申请只移动指针，不加锁也不调用 malloc；释放为空操作，任务执行完后由工作线程整体重置
+//   重置时不调用析构函数，只适合缓冲区和可平凡析构的对象；内存不能在任务结束后继续使用
+//   工作线程在等待期间执行的其他任务 (协作式等待) 结束时只回退到它开始时的位置，不影响外层任务
+//   内存块按需申请，重置后保留 MAX_RETAINED 块复用；超过 CHUNK_SIZE / 4 的申请单独分配，重置时释放
+class TaskArena {
+public:
+	static const size_t CHUNK_SIZE = 64 * 1024;  // 内存块大小
+	static const size_t MAX_RETAINED = 4;  // 重置后保留的内存块数量
+
+	struct Mark {  // 内存区的位置，用于回退
+		size_t chunk;
+		size_t offset;
+		size_t large;
+	};
+
+	TaskArena();
+	~TaskArena();
+	TaskArena(const TaskArena &) = delete;
+	TaskArena &operator=(const TaskArena &) = delete;
+
+	void *allocate(size_t, size_t align = alignof(std::max_align_t));  // 申请内存
+
+	template<typename T, typename... Args>
+	T *create(Args &&...args) {  // 在内存区中构造对象，不会被析构
+		static_assert(std::is_trivially_destructible<T>::value, "TaskArena 重置时不调用析构函数");
+		return new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	Mark mark() const;  // 当前位置
+	void rewind(const Mark &);  // 回退到之前的位置，其后申请的内存全部失效
+	void reset();  // 回退到起点，并释放多余的内存块
+	size_t used() const;  // 已申请的字节数 (不含单独分配的内存)
+
+	static TaskArena *current() { return m_current; }  // 当前工作线程的内存区，非工作线程为 nullptr
+	static void bind(TaskArena *arena) { m_current = arena; }  // 设置当前线程的内存区
+
+private:
+	std::vector<char*> m_chunks;  // 已申请的内存块
+	std::vector<void*> m_large;  // 单独分配的大块内存
+	size_t m_chunk;  // 正在使用的内存块下标
+	size_t m_offset;  // 正在使用的内存块中已用的字节数
+
+	static thread_local TaskArena *m_current;
+
+	void *allocateLarge(size_t);  // 单独分配大块内存
+};
+
+
+/*
+***************************内存区分配器***************************
+*/
+
+// 满足标准库分配器要求，用于任务内的临时容器: std::vector<int, ArenaAllocator<int>> v;
+// 构造时记录当前线程的内存区，不在工作线程中时退化为 ::operator new / ::operator delete
+template<typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind {
+		using other = ArenaAllocator<U>;
+	};
+
+	ArenaAllocator() noexcept : m_arena(TaskArena::current()) { }
+	explicit ArenaAllocator(TaskArena *arena) noexcept : m_arena(arena) { }
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_arena(other.arena()) { }
+
+	T *allocate(size_t n) {
+		if (this->m_arena)
+			return static_cast<T*>(this->m_arena->allocate(n * sizeof(T), alignof(T)));
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, size_t) noexcept {
+		if (!this->m_arena)
+			::operator delete(p);
+	}
+
+	TaskArena *arena() const noexcept { return this->m_arena; }
+
+private:
+	TaskArena *m_arena;  // 所用的内存区，为空表示使用 ::operator new
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena() == b.arena(); }
+
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena() != b.arena(); }
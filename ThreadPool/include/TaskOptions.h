@@ -0,0 +1,131 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 20:05:37
+ * @last_edit_time: 2026-10-17 20:05:37
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/TaskOptions.h
+ * @description: 任务提交选项头文件: 取消令牌、截止时间以及任务未执行的原因
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+/*
+***************************任务未执行的原因***************************
+*/
+
+enum class TaskAbortReason : char {
+	REJECTED,  // 提交被拒绝 (任务队列已满且等待超时)
+	CANCELLED,  // 执行前已被取消
+	EXPIRED  // 执行前已超过截止时间
+};
+
+
+// 任务未执行时写入 future 的异常，get() 时抛出，通过 reason() 区分原因
+class TaskAborted : public std::runtime_error {
+private:
+	TaskAbortReason m_reason;
+
+	static const char *describe(TaskAbortReason reason) {
+		switch (reason) {
+		case TaskAbortReason::REJECTED:
+			return "task rejected: task queue is full";
+		case TaskAbortReason::CANCELLED:
+			return "task cancelled";
+		default:
+			return "task expired";
+		}
+	}
+
+public:
+	explicit TaskAborted(TaskAbortReason reason) : std::runtime_error(describe(reason)), m_reason(reason) { }
+
+	TaskAbortReason reason() const { return this->m_reason; }
+};
+
+
+/*
+***************************取消令牌***************************
+*/
+
+// 可复制，副本共享同一个取消标志；一个令牌可以同时关联多个任务
+class CancellationToken {
+private:
+	std::shared_ptr<std::atomic<bool>> m_cancelled;
+
+	friend class TaskOptions;
+
+public:
+	CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) { }
+
+	void cancel() { this->m_cancelled->store(true, std::memory_order_release); }  // 取消，尚未开始执行的关联任务将被跳过
+	bool isCancelled() const { return this->m_cancelled->load(std::memory_order_acquire); }  // 是否已取消
+};
+
+
+/*
+***************************任务提交选项***************************
+*/
+
+// 用法: pool.submitTask(TaskOptions().setToken(token).setTimeout(std::chrono::milliseconds(100)), func, args...)
+// 任务在工作线程取出后、执行前检查选项，已取消或已过期的任务不执行，future 得到 TaskAborted
+class TaskOptions {
+private:
+	std::shared_ptr<std::atomic<bool>> m_cancelled;  // 取消标志，为空表示不可取消
+	std::chrono::steady_clock::time_point m_deadline;  // 截止时间
+
+public:
+	TaskOptions() : m_deadline(std::chrono::steady_clock::time_point::max()) { }
+
+	/**
+	 * @description: 关联取消令牌
+	 * @param {CancellationToken} &token: 取消令牌
+	 * @return {TaskOptions &} *this
+	 */
+	TaskOptions &setToken(const CancellationToken &token) {
+		this->m_cancelled = token.m_cancelled;
+		return *this;
+	}
+
+	/**
+	 * @description: 设置截止时间，超过截止时间仍未开始执行的任务被丢弃
+	 * @param {time_point} deadline: 截止时间
+	 * @return {TaskOptions &} *this
+	 */
+	TaskOptions &setDeadline(std::chrono::steady_clock::time_point deadline) {
+		this->m_deadline = deadline;
+		return *this;
+	}
+
+	/**
+	 * @description: 以当前时间加上时长作为截止时间
+	 * @param {duration} timeout: 时长
+	 * @return {TaskOptions &} *this
+	 */
+	template<typename Rep, typename Period>
+	TaskOptions &setTimeout(const std::chrono::duration<Rep, Period> &timeout) {
+		this->m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+		return *this;
+	}
+
+	/**
+	 * @description: 任务是否应当被丢弃；只有设置了截止时间才读取时钟
+	 * @param {TaskAbortReason} &reason: 丢弃原因
+	 * @return {bool} true/false
+	 */
+	bool shouldAbort(TaskAbortReason &reason) const {
+		if (this->m_cancelled && this->m_cancelled->load(std::memory_order_acquire)) {
+			reason = TaskAbortReason::CANCELLED;
+			return true;
+		}
+		if (this->m_deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() > this->m_deadline) {
+			reason = TaskAbortReason::EXPIRED;
+			return true;
+		}
+		return false;
+	}
+};
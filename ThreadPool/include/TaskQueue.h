@@ -0,0 +1,42 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 10:02:11
+ * @last_edit_time: 2026-10-17 10:02:11
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/TaskQueue.h
+ * @description: 线程池任务队列接口头文件
+ */
+
+#pragma once
+#include <cstddef>
+
+/*
+***************************任务队列类型***************************
+*/
+enum class TaskQueueMode : char {
+	PRIORITY,  // 带优先级的加锁队列 (SafeQueue)，分桶 + 位图，同一优先级先进先出
+	LOCK_FREE  // 无锁有界环形队列 (LockFreeQueue)，忽略任务优先级
+};
+
+
+/*
+***************************任务队列接口***************************
+*/
+
+// 线程池通过该接口访问任务队列，不同实现可按线程池选择
+template<typename T>
+class TaskQueue {
+public:
+	/* 析构函数 */
+	virtual ~TaskQueue() { }
+
+	/* 成员函数 */
+	virtual bool empty() = 0;  // 队列是否为空
+	virtual size_t safeQueueSize() = 0;  // 任务队列大小
+	virtual bool taskEnqueue(T &, size_t) = 0;  // 添加任务，队列已满时返回 false
+	virtual size_t taskEnqueueBatch(T *, size_t, size_t) = 0;  // 批量添加任务，返回实际添加的数量
+	virtual bool setCapacity(size_t) = 0;  // 设置容量 (线程池的任务量最大值)，实现无法满足时返回 false
+	virtual bool taskDequeue(T &) = 0;  // 取出任务，队列为空时返回 false
+	virtual void setAging(size_t) { }  // 设置老化间隔，不支持优先级的实现忽略
+};
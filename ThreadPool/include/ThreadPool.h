@@ -22,7 +22,37 @@
 #include <iostream>
 #include <atomic>
 #include <condition_variable>
+#include <memory>
+#include <random>
+#include <tuple>
+#include "Task.h"
+#include "PoolAllocator.h"
+#include "TaskQueue.h"
 #include "SafeQueue.h"
+#include "LockFreeQueue.h"
+#include "WorkStealingQueue.h"
+#include "TimerWheel.h"
+#include "TaskOptions.h"
+#include "CpuTopology.h"
+#include "TaskArena.h"
+#include "PoolStats.h"
+
+
+// 详细跟踪输出 (领取任务、线程休眠与增减等)，每条都要争抢 std::cout 的锁，默认不编译
+// 需要时定义 THREADPOOL_TRACE (CMake: -DTHREADPOOL_TRACE=ON)；运行状况改由 ThreadPool::stats() 获取
+#ifdef THREADPOOL_TRACE
+#define POOL_TRACE(message) do { std::cout << message << std::endl; } while (0)
+#else
+#define POOL_TRACE(message) do { } while (0)
+#endif
+
+
+template<typename T>
+class PoolFuture;  // 线程池原生的 future，定义在 PoolFuture.h
+
+namespace coro {
+	struct ScheduleAwaiter;  // co_await pool.schedule() 的等待体，定义在 PoolCoroutine.h (C++20)
+}
 
 
 /*
@@ -32,7 +62,179 @@
 // C++11 枚举类的优势: 1、降低命名空间污染； 2、 避免发生隐式转换； 3、 可以前置声明
 enum class ThreadPoolWorkMode : char {
 	FIXED_THREAD,
-	MUTABLE_THREAD
+	MUTABLE_THREAD,
+	WORK_STEALING
+};
+
+
+/*
+***************************绑定参数的任务函数***************************
+*/
+
+// C++11 没有 std::index_sequence，用于展开参数元组
+template<size_t... I>
+struct IndexSequence { };
+
+template<size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> { };
+
+template<size_t... I>
+struct MakeIndexSequence<0, I...> {
+	using type = IndexSequence<I...>;
+};
+
+// 与 std::bind 一致，std::ref 传入的参数以引用形式传递给任务函数
+template<typename T>
+inline T &unwrapArgument(T &t) { return t; }
+
+template<typename T>
+inline T &unwrapArgument(std::reference_wrapper<T> &t) { return t.get(); }
+
+
+// 持有任务函数、参数以及 promise，执行后将结果 (或异常) 写入 promise
+// 代替原先的 std::bind + std::function + std::packaged_task + std::function 多层包装
+// 未执行就被销毁时 (提交超时) 写入 TaskAborted(REJECTED)，future 不会停留在未就绪状态
+template<typename R, typename F, typename... Args>
+class PromiseTask {
+private:
+	std::promise<R> m_promise;  // 任务结果
+	F m_func;  // 任务函数
+	std::tuple<Args...> m_args;  // 任务函数参数
+	bool m_armed;  // promise 尚未写入结果，移动后的源对象为 false
+
+	template<size_t... I>
+	void invoke(IndexSequence<I...>, std::false_type) {  // 有返回值
+		this->m_promise.set_value(this->m_func(unwrapArgument(std::get<I>(this->m_args))...));
+	}
+
+	template<size_t... I>
+	void invoke(IndexSequence<I...>, std::true_type) {  // 无返回值
+		this->m_func(unwrapArgument(std::get<I>(this->m_args))...);
+		this->m_promise.set_value();
+	}
+
+public:
+	template<typename Fn, typename... As>
+	PromiseTask(std::promise<R> &&promise, Fn &&func, As &&... args)
+		: m_promise(std::move(promise))
+		, m_func(std::forward<Fn>(func))
+		, m_args(std::forward<As>(args)...)
+		, m_armed(true)
+	{ }
+
+	PromiseTask(PromiseTask &&other) noexcept(std::is_nothrow_move_constructible<F>::value && std::is_nothrow_move_constructible<std::tuple<Args...>>::value)
+		: m_promise(std::move(other.m_promise))
+		, m_func(std::move(other.m_func))
+		, m_args(std::move(other.m_args))
+		, m_armed(other.m_armed)
+	{
+		other.m_armed = false;
+	}
+
+	~PromiseTask() {
+		if (this->m_armed)
+			this->abort(TaskAbortReason::REJECTED);
+	}
+
+	void operator()() {
+		this->m_armed = false;
+		try {
+			this->invoke(typename MakeIndexSequence<sizeof...(Args)>::type(), std::is_void<R>());
+		}
+		catch (...) {
+			this->m_promise.set_exception(std::current_exception());
+		}
+	}
+
+	void abort(TaskAbortReason reason) {  // 不执行任务函数，future 得到 TaskAborted
+		this->m_armed = false;
+		this->m_promise.set_exception(std::make_exception_ptr(TaskAborted(reason)));
+	}
+};
+
+
+// 持有任务函数与参数，不关心结果，用于 post / submitBatch
+// 没有 future 可以传递异常，任务抛出的异常在这里截获，避免工作线程因未捕获的异常而终止
+template<typename F, typename... Args>
+class DetachedTask {
+private:
+	F m_func;  // 任务函数
+	std::tuple<Args...> m_args;  // 任务函数参数
+
+	template<size_t... I>
+	void invoke(IndexSequence<I...>) {
+		this->m_func(unwrapArgument(std::get<I>(this->m_args))...);
+	}
+
+public:
+	template<typename Fn, typename... As>
+	explicit DetachedTask(Fn &&func, As &&... args)
+		: m_func(std::forward<Fn>(func))
+		, m_args(std::forward<As>(args)...)
+	{ }
+
+	void operator()() {
+		try {
+			this->invoke(typename MakeIndexSequence<sizeof...(Args)>::type());
+		}
+		catch (const std::exception &e) {
+			std::cerr << "任务执行异常: " << e.what() << std::endl;
+		}
+		catch (...) {
+			std::cerr << "任务执行异常" << std::endl;
+		}
+	}
+
+	void abort(TaskAbortReason) { }  // 没有 future，直接丢弃
+};
+
+
+// 执行前检查取消标志与截止时间，已取消或已过期时不执行任务函数，由内层任务记录原因
+template<typename Inner>
+class GuardedTask {
+private:
+	Inner m_task;  // PromiseTask / DetachedTask 等
+	TaskOptions m_options;  // 任务提交选项
+
+public:
+	GuardedTask(Inner &&task, const TaskOptions &options) : m_task(std::move(task)), m_options(options) { }
+
+	void operator()() {
+		TaskAbortReason reason;
+		if (this->m_options.shouldAbort(reason))
+			this->m_task.abort(reason);
+		else
+			this->m_task();
+	}
+};
+
+
+/*
+***************************定时任务***************************
+*/
+
+// 周期任务的共享部分，每个周期向线程池提交一次 PeriodicRun
+struct PeriodicJob {
+	Task func;  // 任务函数，可重复调用
+	std::atomic<bool> running;  // 上一次执行尚未结束时跳过本周期，避免同一任务重叠执行
+
+	explicit PeriodicJob(Task &&f) : func(std::move(f)), running(false) { }
+};
+
+struct PeriodicRun {
+	std::shared_ptr<PeriodicJob> job;
+
+	void operator()() {
+		this->job->func();
+		this->job->running = false;
+	}
+};
+
+// 时间轮中保存的定时器
+struct TimerTask {
+	Task job;  // 一次性任务
+	std::shared_ptr<PeriodicJob> periodic;  // 周期任务，为空表示一次性任务
+	uint64_t period;  // 周期 (刻度)
 };
 
 
@@ -44,45 +246,126 @@ class ThreadPool {
 private:
 	/* 线程池相关设置 */
 	static int m_threads_id;  // 线程 id，静态成员变量，用于传递给工作线程使用
-	bool m_close; // 关闭线程池
+	std::atomic_bool m_close; // 关闭线程池
 	std::mutex m_mutex; // 互斥锁
 	std::chrono::milliseconds m_timeout;  // 任务提交超时
-	size_t m_priority_level;  // 任务优先级等级
+	std::atomic<size_t> m_priority_level;  // 任务优先级等级
 	ThreadPoolWorkMode m_mode;  // 线程池的工作模式
 
 	/* 任务队列 */
-	SafeQueue<std::function<void()>> m_task_queue; // 函数任务队列
+	TaskQueueMode m_queue_mode;  // 任务队列类型
+	std::unique_ptr<TaskQueue<Task>> m_task_queue; // 函数任务队列
 	std::condition_variable m_conditional_safe_queue_not_full;  // 任务已满
 	std::condition_variable m_conditional_safe_queue_not_empty; // 任务为空
-	size_t m_max_task;  // 最大任务量
+	std::atomic<size_t> m_max_task;  // 最大任务量
+	std::atomic<size_t> m_waiting_submitters;  // 因任务队列已满而等待的提交者数量
 
 	/* 工作线程 */
 	std::unordered_map<int, std::thread> m_threads;  // 线程队列
 	size_t m_max_threshold;  // 线程上限
 	size_t m_min_threshold;  // 线程下限
 	std::atomic_int m_thread_amount;  // 线程数量
+	std::atomic<size_t> m_spin_count;  // 休眠前自旋检查任务的次数
+	std::atomic<size_t> m_yield_count;  // 自旋后让出时间片检查任务的次数
+
+	/* 线程数量控制 (可变线程模式) */
+	struct ControllerState {  // 爬山法的采样状态，只由控制线程访问
+		size_t last_completed;  // 上一次采样时已执行的任务数量
+		double last_throughput;  // 上一次采样的吞吐量 (任务/秒)
+		bool climbed;  // 上一次采样是否增加了线程
+		size_t hold;  // 剩余的暂停爬坡采样次数
+		size_t idle_samples;  // 连续空闲的采样次数
+	};
+	std::thread m_controller;  // 后台控制线程，按吞吐量与排队时间调整线程数量
+	std::condition_variable m_controller_condition;  // 控制线程的采样间隔等待
+	ControllerState m_control;  // 控制线程的采样状态
+	std::atomic<size_t> m_completed_tasks;  // 已执行的任务数量，用于计算吞吐量
+	std::atomic<size_t> m_retire_requests;  // 要求退出的线程数量，来自控制线程或结束的阻塞区域
+
+	/* 阻塞区域补偿 */
+	size_t m_blocked_workers;  // 处于阻塞区域中的工作线程数量，受 m_mutex 保护
+	size_t m_compensating;  // 为阻塞区域临时添加的补偿线程数量，受 m_mutex 保护
+	size_t m_max_compensation;  // 补偿线程数量上限，默认 64
+	static thread_local bool m_blocking;  // 当前线程是否处于阻塞区域中，嵌套的阻塞区域不重复补偿
+
+	/* 工作窃取 */
+	std::vector<std::unique_ptr<WorkStealingQueue<Task>>> m_local_queues;  // 工作线程私有的双端队列，下标即工作线程下标
+	std::atomic<size_t> m_pending_tasks;  // 全局队列与私有队列中尚未取出的任务总数
+	std::atomic<size_t> m_idle_workers;  // 正在休眠等待任务的线程数量
+	std::atomic<size_t> m_joiners;  // 正在协作式等待 (helpUntil) 中休眠的线程数量，任务完成时需要唤醒它们
+	static thread_local ThreadPool *m_current_pool;  // 当前线程所属的线程池，非工作线程为 nullptr
+	static thread_local size_t m_current_index;  // 当前线程在所属线程池中的下标
+	static thread_local std::vector<Task> m_batch_buffer;  // 批量提交的暂存区，容量保留以便复用；提交期间由 submitBatch 取走
+
+	/* 绑核与 NUMA */
+	AffinityMode m_affinity;  // 绑核策略
+	std::vector<int> m_worker_cpus;  // 第 i 个线程绑定第 i % size 个 CPU，为空表示不绑核
+	std::vector<int> m_worker_nodes;  // 工作窃取模式下每个私有队列所属线程的 NUMA 节点，只有多个节点时才有
+	std::vector<std::vector<size_t>> m_node_workers;  // 每个 NUMA 节点上的线程下标，窃取时优先同一节点
+
+	/* 运行统计 */
+	StatsRegistry m_stats;  // 各工作线程的计数器
+	static thread_local StatsCounters *m_current_counters;  // 当前工作线程的计数器，非工作线程为 nullptr
+
+	/* 定时任务 */
+	TimerWheel<TimerTask> m_timer_wheel;  // 时间轮，一个刻度为 1 毫秒
+	std::mutex m_timer_mutex;  // 时间轮互斥锁
+	std::condition_variable m_timer_condition;  // 定时器线程休眠等待
+	std::thread m_timer_thread;  // 定时器线程，首次调度定时任务时启动
+	bool m_timer_stop;  // 定时器线程是否需要退出
+	uint64_t m_timer_wake;  // 定时器线程计划醒来的刻度
+	std::chrono::steady_clock::time_point m_timer_epoch;  // 刻度 0 对应的时间
 
 
 	/* 工作线程类 */
 	class Worker {
 	private:
 		int m_id; // 工作 id
+		size_t m_index;  // 工作线程下标，对应私有队列
 		ThreadPool *m_pool; // 所属线程池
 
+		void workStealing();  // 工作窃取模式下的工作函数
+
 	public:
-		Worker(ThreadPool*, const int);  // 含参构造函数
+		Worker(ThreadPool*, const int, const size_t index = 0);  // 含参构造函数
 		void operator()();  // 重载()，仿函数
 	};
 
 
 private:
 void initThreadPool();  // 初始化线程池
+void initAffinity(const std::vector<int> &);  // 按绑核策略分配 CPU，并按 NUMA 节点给工作线程分组
+void addThread();  // 动态添加线程
+bool enqueueTask(Task &);  // 任务入队
+size_t enqueueTasks(Task *, size_t);  // 批量任务入队
+size_t tryEnqueue(Task *, size_t, size_t);  // 在任务量最大值以内尝试入队，不等待
+bool acquireTask(size_t, std::minstd_rand &, Task &);  // 工作窃取模式下获取任务
+void controlThreads();  // 控制线程的工作函数，定期采样并调整线程数量
+void adjustThreads();  // 根据一次采样调整线程数量，调用者需持有线程池锁
+bool tryRetire(int);  // 响应退出要求，调用者需持有线程池锁
+void enterBlocking();  // 工作线程进入阻塞区域，必要时添加补偿线程
+void leaveBlocking();  // 工作线程离开阻塞区域，释放多余的补偿线程
+bool spinForTask();  // 休眠前先自旋、再让出时间片，等待期间出现任务返回 true
+void wakeIdleWorker();  // 唤醒一个休眠的线程
+void wakeIdleWorkers(size_t);  // 唤醒多个休眠的线程
+void wakeWaitingSubmitter();  // 唤醒因任务队列已满而等待的提交者
+void notifyJoiners();  // 任务完成后唤醒协作式等待中休眠的线程
+StatsCounters &localCounters();  // 当前线程应写入的计数器
+void detachCounters();  // 工作线程退出前注销自己的计数器
+template <typename Inner>
+bool enqueueGuarded(const TaskOptions &, Inner &&);  // 按提交选项包装任务并入队，已取消或已过期时直接丢弃
+uint64_t addTimer(TimerTask &&, std::chrono::steady_clock::duration);  // 添加定时器，必要时启动定时器线程
+void timerLoop();  // 定时器线程的工作函数
+uint64_t fireTimer(TimerTask &, uint64_t, uint64_t);  // 定时器到期，将任务提交到线程池
+uint64_t currentTick() const;  // 当前时间对应的刻度，向下取整
+static uint64_t ticksOf(std::chrono::steady_clock::duration);  // 时长对应的刻度数，向上取整
 
 
 public:
 	/* 构造函数 */
 	ThreadPool();  // 默认构造函数
-	explicit ThreadPool(const size_t, ThreadPoolWorkMode work_mode = ThreadPoolWorkMode::FIXED_THREAD);  // 含参构造函数，且关闭隐式转换
+	explicit ThreadPool(const size_t, ThreadPoolWorkMode work_mode = ThreadPoolWorkMode::FIXED_THREAD, TaskQueueMode queue_mode = TaskQueueMode::PRIORITY,
+		AffinityMode affinity = AffinityMode::NONE, const std::vector<int> &cpus = std::vector<int>());  // 含参构造函数，且关闭隐式转换
 	ThreadPool(const ThreadPool &) = delete;  // 删除拷贝构造函数
 	ThreadPool(ThreadPool &&) = delete;  // 删除移动构造函数
 	ThreadPool &operator=(const ThreadPool &) = delete;  // 删除赋值构造函数
@@ -97,13 +380,85 @@ public:
 	template <typename F, typename... Args>
 	auto submitTask(F &&f, Args &&...args) -> std::future<decltype(f(args...))>;  // 提交异步执行的函数
 
+	template <typename F, typename... Args>
+	auto post(F &&f, Args &&...args) -> typename std::enable_if<!std::is_same<typename std::decay<F>::type, TaskOptions>::value, bool>::type;  // 提交异步执行的函数，不返回 future
+
+	template <typename F, typename... Args>
+	auto async(F &&f, Args &&...args) -> PoolFuture<decltype(f(args...))>;  // 提交异步执行的函数，返回支持续延的线程池 future
+
+	/* 带提交选项 (取消令牌、截止时间) 的版本，任务执行前已取消或已过期时不执行 */
+	template <typename F, typename... Args>
+	auto submitTask(const TaskOptions &options, F &&f, Args &&...args) -> std::future<decltype(f(args...))>;
+
+	template <typename F, typename... Args>
+	bool post(const TaskOptions &options, F &&f, Args &&...args);
+
+	template <typename F, typename... Args>
+	auto async(const TaskOptions &options, F &&f, Args &&...args) -> PoolFuture<decltype(f(args...))>;
+
+	template <typename Iterator>
+	size_t submitBatch(Iterator first, Iterator last);  // 批量提交无参函数，不返回 future
+
+	template <typename Range>
+	size_t submitBatch(const Range &range);  // 批量提交容器中的无参函数，不返回 future
+
+	bool tryPost(Task &);  // 尝试提交任务，不等待，失败时任务保持不变
+	bool runPendingTask();  // 在当前线程取出并执行一个尚未执行的任务
+	bool isWorkerThread() const;  // 当前线程是否为本线程池的工作线程
+
+	template <typename Predicate>
+	void helpUntil(Predicate ready);  // 协作式等待：执行其他任务，直到 ready() 为真
+
+	template <typename Future>
+	void wait(Future &future);  // 等待 future，工作线程在等待期间执行其他任务
+
+	template <typename Future>
+	auto get(Future &future) -> decltype(future.get());  // 等待并获取 future 的结果，工作线程在等待期间执行其他任务
+
+	// 阻塞区域: 任务在阻塞 I/O (如 recvMessage()、sleep()) 前构造，作用域结束时离开
+	// 工作线程处于阻塞区域期间，线程池临时添加一个补偿线程，其他任务不会因阻塞的任务而饿死
+	// 用法: { ThreadPool::blocking_region region; msg = tcp->recvMessage(); }
+	class blocking_region {
+	private:
+		ThreadPool *m_pool;  // 当前工作线程所属的线程池，不在工作线程中或嵌套时为空
+
+	public:
+		blocking_region();  // 进入阻塞区域
+		~blocking_region();  // 离开阻塞区域
+		blocking_region(const blocking_region &) = delete;
+		blocking_region &operator=(const blocking_region &) = delete;
+	};
+
+	using TimerId = TimerWheel<TimerTask>::TimerId;  // 定时任务编号，用于取消
+
+	template <typename Rep, typename Period, typename F>
+	TimerId schedule_after(const std::chrono::duration<Rep, Period> &delay, F &&f);  // 延迟 delay 后执行一次无参函数
+
+	template <typename Rep, typename Period, typename F>
+	TimerId schedule_every(const std::chrono::duration<Rep, Period> &period, F &&f);  // 每隔 period 执行一次无参函数
+
+	bool cancel_timer(TimerId);  // 取消定时任务，已执行 (一次性任务) 或不存在时返回 false
+
+	// 协程切换到线程池: co_await pool.schedule(); 之后的代码在工作线程中执行，需包含 PoolCoroutine.h (C++20)
+	// 写成模板是为了让 C++11 的翻译单元也能看到同一个类定义，不使用时不会实例化
+	template <typename Awaiter = coro::ScheduleAwaiter>
+	Awaiter schedule() { return Awaiter(*this); }
+
+	size_t getTimersAmount();  // 获取尚未到期的定时任务数量
+
+	ThreadPoolStats stats();  // 运行统计快照，不会暂停工作线程
 	inline size_t getThreadsAmount();  // 获取线程数量
-	inline void setTaskMaxAmount(size_t);  // 设置任务量最大值
+	inline size_t getIdleThreadsAmount();  // 获取休眠等待任务的线程数量
+	inline size_t getPendingTasksAmount();  // 获取已提交但尚未取出的任务数量
+	inline bool setTaskMaxAmount(size_t);  // 设置任务量最大值，任务队列无法满足时返回 false
 	inline size_t getTaskMaxAmount();  // 获取任务量最大值
 	inline void setTaskTimeoutByMilliseconds(std::chrono::milliseconds);  // 设置超时时长
 	inline void setTaskTimeoutBySeconds(std::chrono::seconds);  // 设置超时时长
 	inline size_t getTaskPriority();  // 获取任务优先级
 	inline void setTaskPriority(size_t);  // 设置任务优先级
+	inline void setTaskAging(size_t);  // 设置任务老化间隔
+	inline void setMaxCompensation(size_t);  // 设置阻塞区域补偿线程数量上限
+	inline void setIdleSpin(size_t, size_t);  // 设置空闲线程休眠前的自旋次数与让出时间片次数
 };
 
 
@@ -118,6 +473,33 @@ inline size_t ThreadPool::getThreadsAmount() {
 }
 
 
+/**
+ * @description: 获取休眠等待任务的线程数量，无需加锁
+ * @return {size_t} this->m_idle_workers
+ */
+inline size_t ThreadPool::getIdleThreadsAmount() {
+	return this->m_idle_workers;
+}
+
+
+/**
+ * @description: 获取已提交但尚未被线程取出的任务数量，无需加锁
+ * @return {size_t} this->m_pending_tasks
+ */
+inline size_t ThreadPool::getPendingTasksAmount() {
+	return this->m_pending_tasks;
+}
+
+
+/**
+ * @description: 当前线程是否为本线程池的工作线程
+ * @return {bool} true/false
+ */
+inline bool ThreadPool::isWorkerThread() const {
+	return ThreadPool::m_current_pool == this;
+}
+
+
 /**
  * @description: 获取线程池任务量最大值
  * @return {size_t} this->m_max_task
@@ -129,12 +511,22 @@ inline size_t ThreadPool::getTaskMaxAmount() {
 
 
 /**
- * @description: 设置线程池任务量最大值
+ * @description: 设置线程池任务量最大值；无锁队列的容量在构造时确定，超过容量时拒绝，最大值保持不变
  * @param {size_t} max: 任务量最大值
+ * @return {bool} 设置成功返回 true
  */
-inline void ThreadPool::setTaskMaxAmount(size_t max) {
+inline bool ThreadPool::setTaskMaxAmount(size_t max) {
 	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	if (!this->m_task_queue->setCapacity(max)) {
+		POOL_TRACE("任务队列无法容纳 " << max << " 个任务，任务量最大值保持为 " << this->m_max_task);
+		return false;
+	}
+
 	this->m_max_task = max;
+	this->m_conditional_safe_queue_not_full.notify_all();  // 调高时等待中的提交者可以继续
+
+	return true;
 }
 
 
@@ -182,6 +574,36 @@ inline void ThreadPool::setTaskPriority(size_t priority) {
 }
 
 
+/**
+ * @description: 设置任务老化间隔，仅对 PRIORITY 任务队列有效
+ * @param {size_t} aging: 每 aging 次出队中有一次取出等待最久的任务，0 表示严格按优先级 (默认)
+ */
+inline void ThreadPool::setTaskAging(size_t aging) {
+	this->m_task_queue->setAging(aging);
+}
+
+
+/**
+ * @description: 设置阻塞区域补偿线程数量上限，0 表示不补偿
+ * @param {size_t} amount: 补偿线程数量上限
+ */
+inline void ThreadPool::setMaxCompensation(size_t amount) {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+	this->m_max_compensation = amount;
+}
+
+
+/**
+ * @description: 设置空闲线程休眠前的自适应等待，均为 0 时取不到任务立即休眠
+ * @param {size_t} spin: 自旋 (pause 指令) 次数
+ * @param {size_t} yield: 自旋后让出时间片的次数
+ */
+inline void ThreadPool::setIdleSpin(size_t spin, size_t yield) {
+	this->m_spin_count = spin;
+	this->m_yield_count = yield;
+}
+
+
 
 /**
  * @description: 提交异步执行的函数
@@ -194,65 +616,229 @@ auto ThreadPool::submitTask(Func &&func, Args &&... args) -> std::future<decltyp
 
 	// typename std::result_of<Func(Args...)>::type 等同于 decltype(func(args...))
 	using func_renturn_type = typename std::result_of<Func(Args...)>::type;
-	
-	// function<int(int, int)> new_func = bind(old_func, _1, _2);
-	// 将任务函数和参数绑定，打包成 func，先转换成无参函数
-	std::function<func_renturn_type()> nonparam_task_func = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+	using promise_task_type = PromiseTask<func_renturn_type, typename std::decay<Func>::type, typename std::decay<Args>::type...>;
 
-	// 将任务函数（新打包的 func）封装进共享指针中，方便复制(被 lambda 函数值捕捉)
-	auto task_ptr = std::make_shared<std::packaged_task<func_renturn_type()>>(nonparam_task_func);
+	// future 的共享状态由线程私有的内存池分配，不调用 malloc
+	std::promise<func_renturn_type> promise(std::allocator_arg, PoolAllocator<char>());
 
-	// 返回通过 packaged_task 打包的 future
-	auto return_future = (*task_ptr).get_future();
+	// 返回与 promise 关联的 future
+	auto return_future = promise.get_future();
 
+	// 将任务函数和参数一起移入无参无返回值的任务，足够小时直接存放在任务内部
+	Task task(promise_task_type(std::move(promise), std::forward<Func>(func), std::forward<Args>(args)...));
+
+	// 任务入队，提交超时时任务在此析构，future 得到 TaskAborted(REJECTED)
+	this->enqueueTask(task);
+
+	return return_future;
+}
+
+
+/**
+ * @description: 提交带选项的异步执行函数
+ * @param {TaskOptions} &options: 提交选项，任务执行前已取消或已过期时不执行，future 得到 TaskAborted
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {std::future<decltype(func(args...))>} 任务函数形成的 future
+ */
+template <typename Func, typename... Args>
+auto ThreadPool::submitTask(const TaskOptions &options, Func &&func, Args &&... args) -> std::future<decltype(func(args...))> {
+	using func_renturn_type = typename std::result_of<Func(Args...)>::type;
+	using promise_task_type = PromiseTask<func_renturn_type, typename std::decay<Func>::type, typename std::decay<Args>::type...>;
+
+	std::promise<func_renturn_type> promise(std::allocator_arg, PoolAllocator<char>());
+	auto return_future = promise.get_future();
+
+	this->enqueueGuarded(options, promise_task_type(std::move(promise), std::forward<Func>(func), std::forward<Args>(args)...));
+
+	return return_future;
+}
+
+
+/**
+ * @description: 提交带选项的异步执行函数，不创建 promise/future
+ * @param {TaskOptions} &options: 提交选项，任务执行前已取消或已过期时直接丢弃
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {bool} 入队成功返回 true，提交超时或提交时已取消/已过期返回 false
+ */
+template <typename Func, typename... Args>
+bool ThreadPool::post(const TaskOptions &options, Func &&func, Args &&... args) {
+	using detached_task_type = DetachedTask<typename std::decay<Func>::type, typename std::decay<Args>::type...>;
+
+	return this->enqueueGuarded(options, detached_task_type(std::forward<Func>(func), std::forward<Args>(args)...));
+}
+
+
+/**
+ * @description: 按提交选项包装任务并入队；提交时已取消或已过期的任务不入队，直接记录原因
+ * @param {TaskOptions} &options: 提交选项
+ * @param {Inner} &&inner: 具有 abort(TaskAbortReason) 的任务
+ * @return {bool} 是否入队成功
+ */
+template <typename Inner>
+bool ThreadPool::enqueueGuarded(const TaskOptions &options, Inner &&inner) {
+	using inner_type = typename std::decay<Inner>::type;
+
+	TaskAbortReason reason;
+	if (options.shouldAbort(reason)) {
+		inner.abort(reason);
+		return false;
+	}
+
+	Task task(GuardedTask<inner_type>(std::move(inner), options));
+
+	return this->enqueueTask(task);
+}
+
+/**
+ * @description: 延迟执行无参函数，到期时由定时器线程提交到线程池，不创建 future
+ * @param {duration} delay: 延迟时长，精度为 1 毫秒
+ * @param {F} &&f: 无参函数，抛出的异常被截获并输出
+ * @return {TimerId} 定时任务编号，可用于 cancel_timer
+ */
+template <typename Rep, typename Period, typename F>
+ThreadPool::TimerId ThreadPool::schedule_after(const std::chrono::duration<Rep, Period> &delay, F &&f) {
+	TimerTask timer;
+	timer.job = Task(DetachedTask<typename std::decay<F>::type>(std::forward<F>(f)));
+	timer.period = 0;
+
+	return this->addTimer(std::move(timer), std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay));
+}
+
+
+/**
+ * @description: 周期执行无参函数，首次在一个周期后执行；上一次执行尚未结束时跳过本周期
+ * @param {duration} period: 周期，精度为 1 毫秒，至少 1 毫秒
+ * @param {F} &&f: 无参函数，会被重复调用，抛出的异常被截获并输出
+ * @return {TimerId} 定时任务编号，可用于 cancel_timer
+ */
+template <typename Rep, typename Period, typename F>
+ThreadPool::TimerId ThreadPool::schedule_every(const std::chrono::duration<Rep, Period> &period, F &&f) {
+	std::chrono::steady_clock::duration interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+	uint64_t ticks = ThreadPool::ticksOf(interval);
+
+	TimerTask timer;
+	timer.periodic = std::make_shared<PeriodicJob>(Task(DetachedTask<typename std::decay<F>::type>(std::forward<F>(f))));
+	timer.period = ticks > 0 ? ticks : 1;
+
+	return this->addTimer(std::move(timer), interval);
+}
+
+
+/**
+ * @description: 协作式等待，反复执行线程池中尚未执行的任务，直到 ready() 为真；
+ *               没有可执行的任务时休眠，有新任务提交或任意任务完成时被唤醒
+ * @param {Predicate} ready: 等待条件，无参并返回 bool
+ */
+template <typename Predicate>
+void ThreadPool::helpUntil(Predicate ready) {
+	while (!ready()) {
+		if (this->runPendingTask())
+			continue;
 
-	{
-		// 线程池加锁
 		std::unique_lock<std::mutex> lock(this->m_mutex);
+		this->m_joiners++;
+		this->m_idle_workers++;
+		std::atomic_thread_fence(std::memory_order_seq_cst);  // 保证先登记再检查条件，与 notifyJoiners() 配对
 
-		// 将打包好的无参任务函数转换成 void 函数
-		std::function<void()> warpper_func = [task_ptr]() {
-			(*task_ptr)();  //  (*指针变量名) (函数参数列表)
-		};
+		// 不依赖唤醒的条件 (例如等待其他线程池的 future) 通过超时重新检查
+		this->m_conditional_safe_queue_not_empty.wait_for(lock, std::chrono::milliseconds(1), [this, &ready]() {
+			return ready() || this->m_pending_tasks > 0;
+		});
+
+		this->m_idle_workers--;
+		this->m_joiners--;
+	}
+}
+
+
+/**
+ * @description: 等待 future 就绪；在本线程池的工作线程中调用时，等待期间执行其他任务，
+ *               避免 FIXED_THREAD 模式下嵌套任务等待子任务而耗尽线程甚至死锁
+ * @param {Future} &future: std::future 或 std::shared_future
+ */
+template <typename Future>
+void ThreadPool::wait(Future &future) {
+	if (!this->isWorkerThread()) {
+		future.wait();
+		return ;
+	}
+
+	this->helpUntil([&future]() {
+		return future.wait_for(std::chrono::seconds(0)) != std::future_status::timeout;
+	});
+}
+
+
+/**
+ * @description: 等待并获取 future 的结果，等待方式同 wait()
+ * @param {Future} &future: std::future 或 std::shared_future
+ * @return {decltype(future.get())} 任务结果，任务抛出的异常在此重新抛出
+ */
+template <typename Future>
+auto ThreadPool::get(Future &future) -> decltype(future.get()) {
+	this->wait(future);
+	return future.get();
+}
 
-		// 如果线程池已经决定关闭，则不可再提交任务
-		if (this->m_close) {
-			std::cout << "线程池已被关闭，无法提交新任务" << std::endl;
-			throw std::runtime_error("ThreadPool is already colsed");
-		}
 
-		// 如果任务数已满，等待线程执行
-		if (this->m_max_task == this->m_task_queue.safeQueueSize()) {
-			std::cout << "任务队列已满, 请等待任务完成" << std::endl;
+/**
+ * @description: 提交异步执行的函数，不创建 promise/future，适用于不关心结果的任务
+ * @param {Func} &: 任务函数
+ * @param {Args &&...} args: 任务函数参数
+ * @return {bool} 入队成功返回 true，提交超时返回 false
+ */
+template <typename Func, typename... Args>
+auto ThreadPool::post(Func &&func, Args &&... args) -> typename std::enable_if<!std::is_same<typename std::decay<Func>::type, TaskOptions>::value, bool>::type {
+	using detached_task_type = DetachedTask<typename std::decay<Func>::type, typename std::decay<Args>::type...>;
 
-			// 用户提交任务，超过时长，否则算提交任务失败
-			if (std::cv_status::timeout == this->m_conditional_safe_queue_not_full.wait_for(lock, std::chrono::milliseconds(this->m_timeout))) {
-				// 表示等待一秒 条件依然没有满足
-				std::cerr << "提交任务超时，请稍后重尝..." << std::endl;
-				return return_future;
-			}
+	Task task(detached_task_type(std::forward<Func>(func), std::forward<Args>(args)...));
+
+	return this->enqueueTask(task);
+}
+
+
+/**
+ * @description: 批量提交无参函数，任务队列只加锁 (或 CAS) 一次，并按任务数量唤醒休眠的线程
+ * @param {Iterator} first: 第一个函数
+ * @param {Iterator} last: 最后一个函数的下一个位置
+ * @return {size_t} 成功提交的任务数量，任务队列已满且等待超时时少于函数数量
+ */
+template <typename Iterator>
+size_t ThreadPool::submitBatch(Iterator first, Iterator last) {
+	using detached_task_type = DetachedTask<typename std::decay<decltype(*first)>::type>;
+
+	// 从线程局部的暂存区取出缓冲区，返回时清空并放回，未入队的任务随之释放
+	// 任务队列已满时工作线程会执行等待中的任务，其中可能再次调用 submitBatch，此时暂存区已被取走，内层调用使用新的缓冲区
+	std::vector<Task> buffer;
+	buffer.swap(ThreadPool::m_batch_buffer);
+	struct BufferGuard {
+		std::vector<Task> &buffer;
+		~BufferGuard() {
+			buffer.clear();
+			ThreadPool::m_batch_buffer.swap(buffer);
 		}
+	} guard{buffer};
 
-		// 任务入队
-		this->m_task_queue.taskEnqueue(warpper_func, this->m_priority_level);
+	for (; first != last; ++first) {
+		buffer.emplace_back(detached_task_type(*first));
 	}
 
-	// 动态添加线程
-	if (this->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD
-		&& this->getThreadsAmount() < this->m_task_queue.safeQueueSize()
-		&& this->getThreadsAmount() < this->m_max_threshold
-		&& this->getThreadsAmount() < std::thread::hardware_concurrency()
-	) {
-		this->m_threads[ThreadPool::m_threads_id] = std::thread(&Worker::operator(), Worker(this, ThreadPool::m_threads_id));  // 指定线程所执行的函数
-		ThreadPool::m_threads_id++;
-		this->m_thread_amount++;
-		std::cout << "已动态添加新线程，当前线程数量为: " << this->getThreadsAmount() << "  ----->   " << this->m_max_threshold << std::endl;
-	}
+	return this->enqueueTasks(buffer.data(), buffer.size());
+}
 
-	// 唤醒一个等待中的线程
-	this->m_conditional_safe_queue_not_empty.notify_one();
-	
-	return return_future;
+
+/**
+ * @description: 批量提交容器中的无参函数
+ * @param {Range} &range: 存放无参函数的容器
+ * @return {size_t} 成功提交的任务数量
+ */
+template <typename Range>
+size_t ThreadPool::submitBatch(const Range &range) {
+	return this->submitBatch(std::begin(range), std::end(range));
 }
 
-#endif  // !THREAD_POOL_H__
\ No newline at end of file
+#include "PoolFuture.h"  // ThreadPool::async 的定义依赖完整的 PoolFuture
+
+#endif  // !THREAD_POOL_H__
@@ -0,0 +1,334 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 18:40:12
+ * @last_edit_time: 2026-10-17 18:40:12
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/TimerWheel.h
+ * @description: 分层时间轮头文件，定时任务的插入与取消均为 O(1)
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+***************************分层时间轮***************************
+*/
+
+// 时间以刻度 (tick) 计，共 LEVELS 层，每层 SLOTS 个槽，第 l 层每个槽跨度为 SLOTS^l 个刻度:
+//   插入: 按到期刻度与当前刻度之差选择层，按到期刻度的对应位选择槽，挂到槽的双向链表上
+//   取消: 定时器编号即节点下标 (附带代数防止误删已复用的节点)，从链表中摘除
+//   推进: 每经过 SLOTS 个刻度，将上一层对应槽中的定时器重新分配到下层 (级联)，第 0 层的槽到期即执行
+//   借助每层的位图直接跳到下一个需要处理的刻度，远期定时器不会导致周期性的空转唤醒
+// 非线程安全，由调用者加锁
+template<typename T>
+class TimerWheel {
+public:
+	using TimerId = uint64_t;  // 高 32 位为代数，低 32 位为节点下标 + 1，0 表示无效
+
+	static const unsigned SLOT_BITS = 8;
+	static const unsigned SLOTS = 1u << SLOT_BITS;  // 每层槽数
+	static const unsigned LEVELS = 4;  // 层数，可直接表示 2^32 个刻度以内的定时器，更远的定时器到达顶层后再次分配
+
+private:
+	static const uint32_t NIL = 0xFFFFFFFFu;
+	static const unsigned WORDS = SLOTS / 64;  // 每层位图的字数
+
+	struct Node {
+		T payload;  // 定时器数据
+		uint64_t expire;  // 到期刻度
+		uint32_t prev;  // 槽链表中的前一个节点
+		uint32_t next;  // 槽链表中的后一个节点，空闲节点复用为空闲链表
+		uint32_t generation;  // 代数，节点每次释放加一
+		uint8_t level;  // 所在层
+		uint8_t slot;  // 所在槽
+		bool linked;  // 是否在时间轮中
+	};
+
+	std::vector<Node> m_nodes;  // 节点，下标稳定
+	uint32_t m_free;  // 空闲节点链表
+	uint32_t m_heads[LEVELS][SLOTS];  // 槽链表头
+	uint64_t m_bitmap[LEVELS][WORDS];  // 槽是否非空
+	uint64_t m_current;  // 已处理到的刻度
+	size_t m_size;  // 定时器数量
+
+	void place(uint32_t index);  // 按到期刻度将节点挂到对应的槽上
+	void unlink(uint32_t index);  // 将节点从所在槽上摘除
+	void release(uint32_t index);  // 释放节点
+	void cascade(unsigned level, unsigned slot);  // 将上层槽中的定时器重新分配
+	int nextSlot(unsigned level, unsigned from) const;  // 第 level 层从 from 开始的第一个非空槽，没有则返回 -1
+
+public:
+	/* 构造函数 */
+	TimerWheel();
+	TimerWheel(const TimerWheel &) = delete;
+	TimerWheel &operator=(const TimerWheel &) = delete;
+
+	/* 成员函数 */
+	bool empty() const { return this->m_size == 0; }  // 是否没有定时器
+	size_t size() const { return this->m_size; }  // 定时器数量
+	uint64_t current() const { return this->m_current; }  // 已处理到的刻度
+
+	TimerId add(uint64_t expire, T &&payload);  // 添加定时器，到期刻度不晚于当前刻度时在下一刻度到期
+	bool cancel(TimerId id);  // 取消定时器，已到期或不存在时返回 false
+	uint64_t nextTick() const;  // 下一个需要处理的刻度 (到期或级联)，没有定时器时返回 UINT64_MAX
+
+	template<typename F>
+	void advance(uint64_t now, F &&on_expire);  // 推进到 now，对每个到期的定时器调用 on_expire
+};
+
+
+/**
+ * @description: 构造函数
+ */
+template<typename T>
+TimerWheel<T>::TimerWheel() : m_free(NIL), m_current(0), m_size(0) {
+	for (unsigned l = 0; l < LEVELS; ++l) {
+		for (unsigned s = 0; s < SLOTS; ++s)
+			this->m_heads[l][s] = NIL;
+		for (unsigned w = 0; w < WORDS; ++w)
+			this->m_bitmap[l][w] = 0;
+	}
+}
+
+
+/**
+ * @description: 添加定时器
+ * @param {uint64_t} expire: 到期刻度
+ * @param {T} &&payload: 定时器数据
+ * @return {TimerId} 定时器编号，用于取消
+ */
+template<typename T>
+typename TimerWheel<T>::TimerId TimerWheel<T>::add(uint64_t expire, T &&payload) {
+	uint32_t index;
+	if (this->m_free != NIL) {
+		index = this->m_free;
+		this->m_free = this->m_nodes[index].next;
+		this->m_nodes[index].payload = std::move(payload);
+	}
+	else {
+		index = (uint32_t)this->m_nodes.size();
+		this->m_nodes.push_back(Node{ std::move(payload), 0, NIL, NIL, 0, 0, 0, false });
+	}
+
+	this->m_nodes[index].expire = expire > this->m_current ? expire : this->m_current + 1;
+	this->place(index);
+	++this->m_size;
+
+	return ((TimerId)this->m_nodes[index].generation << 32) | (TimerId)(index + 1);
+}
+
+
+/**
+ * @description: 取消定时器
+ * @param {TimerId} id: 定时器编号
+ * @return {bool} 是否取消成功
+ */
+template<typename T>
+bool TimerWheel<T>::cancel(TimerId id) {
+	uint32_t low = (uint32_t)(id & 0xFFFFFFFFu);
+	if (low == 0 || low > this->m_nodes.size())
+		return false;
+
+	uint32_t index = low - 1;
+	Node &node = this->m_nodes[index];
+	if (!node.linked || node.generation != (uint32_t)(id >> 32))
+		return false;
+
+	this->unlink(index);
+	this->release(index);
+	return true;
+}
+
+
+/**
+ * @description: 下一个需要处理的刻度，即各层第一个非空槽被处理 (第 0 层到期，其余层级联) 的刻度中最早的一个
+ * @return {uint64_t} 刻度，没有定时器时返回 UINT64_MAX
+ */
+template<typename T>
+uint64_t TimerWheel<T>::nextTick() const {
+	if (this->m_size == 0)
+		return UINT64_MAX;
+
+	uint64_t next = this->m_current + 1;
+	uint64_t best = UINT64_MAX;
+
+	for (unsigned l = 0; l < LEVELS; ++l) {
+		unsigned shift = l * SLOT_BITS;
+		uint64_t aligned = l == 0 ? next : (((next - 1) >> shift) + 1) << shift;  // 第 l 层下一次被处理的刻度
+		unsigned from = (unsigned)((aligned >> shift) & (SLOTS - 1));
+
+		// 按环形顺序查找，from 之前的槽属于下一圈
+		int slot = this->nextSlot(l, from);
+		uint64_t distance;
+		if (slot >= 0)
+			distance = (uint64_t)(slot - (int)from);
+		else if ((slot = this->nextSlot(l, 0)) >= 0)
+			distance = (uint64_t)(SLOTS - from + (unsigned)slot);
+		else
+			continue;
+
+		uint64_t tick = aligned + (distance << shift);
+		if (tick < best)
+			best = tick;
+	}
+
+	return best;
+}
+
+
+/**
+ * @description: 推进到 now，跳过空槽，依次级联并处理到期的槽
+ * @param {uint64_t} now: 当前刻度
+ * @param {F} &&on_expire: uint64_t(T &payload, uint64_t expire)，返回 0 表示释放，否则为重新计时的到期刻度 (编号不变)
+ */
+template<typename T>
+template<typename F>
+void TimerWheel<T>::advance(uint64_t now, F &&on_expire) {
+	while (this->m_current < now) {
+		uint64_t tick = this->nextTick();
+		if (tick > now) {
+			this->m_current = now;
+			break;
+		}
+		this->m_current = tick;
+
+		// 到达新的一圈，从第 1 层开始逐层级联
+		if ((tick & (SLOTS - 1)) == 0) {
+			for (unsigned l = 1; l < LEVELS; ++l) {
+				unsigned slot = (unsigned)((tick >> (l * SLOT_BITS)) & (SLOTS - 1));
+				this->cascade(l, slot);
+				if (slot != 0)
+					break;
+			}
+		}
+
+		// 第 0 层的槽中全部是本刻度到期的定时器
+		unsigned slot = (unsigned)(tick & (SLOTS - 1));
+		while (this->m_heads[0][slot] != NIL) {
+			uint32_t index = this->m_heads[0][slot];
+			this->unlink(index);
+
+			uint64_t next = on_expire(this->m_nodes[index].payload, this->m_nodes[index].expire);
+			if (next == 0) {
+				this->release(index);
+				continue;
+			}
+			this->m_nodes[index].expire = next > tick ? next : tick + 1;
+			this->place(index);
+		}
+	}
+}
+
+
+/**
+ * @description: 按到期刻度与当前刻度之差选择层，按到期刻度的对应位选择槽
+ * @param {uint32_t} index: 节点下标
+ */
+template<typename T>
+void TimerWheel<T>::place(uint32_t index) {
+	Node &node = this->m_nodes[index];
+	uint64_t delta = node.expire - this->m_current;
+
+	unsigned level = 0;
+	while (level + 1 < LEVELS && delta >= ((uint64_t)1 << ((level + 1) * SLOT_BITS)))
+		++level;
+
+	// 超出顶层范围的定时器暂时放在顶层最远的槽，级联时再次分配
+	uint64_t expire = node.expire;
+	uint64_t limit = (uint64_t)1 << (LEVELS * SLOT_BITS);
+	if (delta >= limit)
+		expire = this->m_current + limit - 1;
+
+	unsigned slot = (unsigned)((expire >> (level * SLOT_BITS)) & (SLOTS - 1));
+
+	node.level = (uint8_t)level;
+	node.slot = (uint8_t)slot;
+	node.linked = true;
+	node.prev = NIL;
+	node.next = this->m_heads[level][slot];
+	if (node.next != NIL)
+		this->m_nodes[node.next].prev = index;
+	this->m_heads[level][slot] = index;
+	this->m_bitmap[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+
+/**
+ * @description: 将节点从所在槽上摘除，槽变空时清除位图
+ * @param {uint32_t} index: 节点下标
+ */
+template<typename T>
+void TimerWheel<T>::unlink(uint32_t index) {
+	Node &node = this->m_nodes[index];
+
+	if (node.prev != NIL)
+		this->m_nodes[node.prev].next = node.next;
+	else
+		this->m_heads[node.level][node.slot] = node.next;
+	if (node.next != NIL)
+		this->m_nodes[node.next].prev = node.prev;
+
+	if (this->m_heads[node.level][node.slot] == NIL)
+		this->m_bitmap[node.level][node.slot / 64] &= ~((uint64_t)1 << (node.slot % 64));
+
+	node.linked = false;
+}
+
+
+/**
+ * @description: 释放节点，代数加一使旧编号失效，同时析构定时器数据持有的资源
+ * @param {uint32_t} index: 节点下标
+ */
+template<typename T>
+void TimerWheel<T>::release(uint32_t index) {
+	Node &node = this->m_nodes[index];
+	node.payload = T();
+	++node.generation;
+	node.next = this->m_free;
+	this->m_free = index;
+	--this->m_size;
+}
+
+
+/**
+ * @description: 将上层槽中的定时器按当前刻度重新分配到下层
+ * @param {unsigned} level: 层
+ * @param {unsigned} slot: 槽
+ */
+template<typename T>
+void TimerWheel<T>::cascade(unsigned level, unsigned slot) {
+	uint32_t index = this->m_heads[level][slot];
+	this->m_heads[level][slot] = NIL;
+	this->m_bitmap[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+
+	while (index != NIL) {
+		uint32_t next = this->m_nodes[index].next;
+		this->place(index);
+		index = next;
+	}
+}
+
+
+/**
+ * @description: 借助位图查找第一个非空槽
+ * @param {unsigned} level: 层
+ * @param {unsigned} from: 起始槽
+ * @return {int} 槽下标，没有则返回 -1
+ */
+template<typename T>
+int TimerWheel<T>::nextSlot(unsigned level, unsigned from) const {
+	unsigned word = from / 64;
+	uint64_t bits = this->m_bitmap[level][word] & (~(uint64_t)0 << (from % 64));
+
+	while (true) {
+		if (bits != 0)
+			return (int)(word * 64 + __builtin_ctzll(bits));
+		if (++word == WORDS)
+			return -1;
+		bits = this->m_bitmap[level][word];
+	}
+}
@@ -0,0 +1,152 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 09:12:40
+ * @last_edit_time: 2026-10-17 09:12:40
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/include/WorkStealingQueue.h
+ * @description: 工作窃取模式下，工作线程私有的双端任务队列
+ */
+
+#pragma once
+#include <deque>
+#include <map>
+#include <mutex>
+#include <functional>
+
+/*
+***************************工作窃取队列***************************
+*/
+
+// 每个工作线程独占一个队列：所属线程从队尾存取 (LIFO，缓存友好)，其他线程从队首窃取 (FIFO，优先拿走较早的任务)
+// 队列按任务优先级分层，存取与窃取都优先处理最高优先级的任务
+template<typename T>
+class WorkStealingQueue {
+private:
+	std::map<size_t, std::deque<T>, std::greater<size_t>> m_levels;  // 优先级 -> 双端队列，按优先级降序排列
+	size_t m_size;  // 任务数量
+	std::mutex m_mutex;  // 队列互斥锁，只有窃取发生时才会出现竞争
+
+	// 取空的优先级不删除，优先级种类通常很少，避免反复申请 map 节点
+	typename std::map<size_t, std::deque<T>, std::greater<size_t>>::iterator firstNonEmpty() {
+		auto level = this->m_levels.begin();
+		while (level->second.empty())
+			++level;
+		return level;
+	}
+
+public:
+	/* 构造函数 */
+	WorkStealingQueue() : m_size(0) { }
+	WorkStealingQueue(const WorkStealingQueue &) = delete;
+	WorkStealingQueue &operator=(const WorkStealingQueue &) = delete;
+
+	/* 析构函数 */
+	~WorkStealingQueue() { }
+
+	/* 成员函数 */
+	bool empty();  // 队列是否为空
+	size_t size();  // 队列大小
+	void push(T &&, size_t);  // 所属线程压入任务
+	void pushBatch(T *, size_t, size_t);  // 所属线程批量压入任务
+	bool pop(T &);  // 所属线程从队尾取出任务
+	bool steal(T &);  // 其他线程从队首窃取任务
+};
+
+
+/**
+ * @description: 判断队列是否为空
+ * @return {bool} this->m_size == 0
+ */
+template<typename T>
+bool WorkStealingQueue<T>::empty() {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	return this->m_size == 0;
+}
+
+
+/**
+ * @description: 获取队列大小
+ * @return {size_t} this->m_size
+ */
+template<typename T>
+size_t WorkStealingQueue<T>::size() {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	return this->m_size;
+}
+
+
+/**
+ * @description: 所属线程向队尾压入任务
+ * @param {T} t: 任务函数
+ * @param {size_t} priority: 任务优先级
+ */
+template<typename T>
+void WorkStealingQueue<T>::push(T &&t, size_t priority) {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	this->m_levels[priority].push_back(std::move(t));
+	++this->m_size;
+}
+
+
+/**
+ * @description: 所属线程向队尾批量压入任务，只加锁一次
+ * @param {T} *tasks: 任务数组，压入后被移走
+ * @param {size_t} n: 任务数量
+ * @param {size_t} priority: 任务优先级
+ */
+template<typename T>
+void WorkStealingQueue<T>::pushBatch(T *tasks, size_t n, size_t priority) {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	std::deque<T> &level = this->m_levels[priority];
+	for (size_t i = 0; i < n; ++i) {
+		level.push_back(std::move(tasks[i]));
+	}
+	this->m_size += n;
+}
+
+
+/**
+ * @description: 所属线程从最高优先级的队尾取出任务
+ * @param {T} t: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+template<typename T>
+bool WorkStealingQueue<T>::pop(T &t) {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	if (this->m_size == 0)
+		return false;
+
+	auto level = this->firstNonEmpty();  // 最高优先级
+	t = std::move(level->second.back());
+	level->second.pop_back();
+	--this->m_size;
+
+	return true;
+}
+
+
+/**
+ * @description: 其他线程从最高优先级的队首窃取任务
+ * @param {T} t: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+template<typename T>
+bool WorkStealingQueue<T>::steal(T &t) {
+	std::unique_lock<std::mutex> lock(this->m_mutex, std::try_to_lock);  // 队列正被占用时直接放弃，去窃取下一个线程
+
+	if (!lock.owns_lock() || this->m_size == 0)
+		return false;
+
+	auto level = this->firstNonEmpty();  // 最高优先级
+	t = std::move(level->second.front());
+	level->second.pop_front();
+	--this->m_size;
+
+	return true;
+}
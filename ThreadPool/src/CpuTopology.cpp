@@ -0,0 +1,209 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 21:42:06
+ * @last_edit_time: 2026-10-17 21:42:06
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/src/CpuTopology.cpp
+ * @description: CPU 拓扑源文件
+ */
+
+#include "CpuTopology.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+/**
+ * @description: 探测当前进程可用的 CPU，以及它们所属的 NUMA 节点和物理核心
+ */
+CpuTopology::CpuTopology() : m_nodes(1) {
+	std::vector<int> allowed;
+
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &set))
+				allowed.push_back(cpu);
+		}
+	}
+#endif
+
+	if (allowed.empty()) {
+		for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+			allowed.push_back((int)cpu);
+	}
+
+	for (int cpu : allowed) {
+		this->m_cpus.push_back(Cpu{ cpu, 0, cpu });
+	}
+
+	// NUMA 节点: /sys/devices/system/node/nodeN/cpulist
+	std::vector<int> nodes = parseCpuList(readFile("/sys/devices/system/node/online"));
+	for (int node : nodes) {
+		std::vector<int> cpus = parseCpuList(readFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+		for (Cpu &c : this->m_cpus) {
+			if (std::find(cpus.begin(), cpus.end(), c.id) != cpus.end()) {
+				c.node = node;
+				this->m_nodes = std::max(this->m_nodes, node + 1);
+			}
+		}
+	}
+
+	// 物理核心: 同一核心上的超线程共享 thread_siblings_list
+	for (Cpu &c : this->m_cpus) {
+		std::vector<int> siblings = parseCpuList(readFile("/sys/devices/system/cpu/cpu" + std::to_string(c.id) + "/topology/thread_siblings_list"));
+		if (!siblings.empty()) {
+			c.core = *std::min_element(siblings.begin(), siblings.end());
+		}
+	}
+}
+
+
+/**
+ * @description: 使用给定的拓扑，不读取 sched_getaffinity 与 sysfs
+ * @param {vector<Cpu>} &cpus: 可用的 CPU 及其节点与物理核心
+ */
+CpuTopology::CpuTopology(const std::vector<Cpu> &cpus) : m_cpus(cpus), m_nodes(1) {
+	std::sort(this->m_cpus.begin(), this->m_cpus.end(), [](const Cpu &a, const Cpu &b) { return a.id < b.id; });
+	for (const Cpu &c : this->m_cpus) {
+		this->m_nodes = std::max(this->m_nodes, c.node + 1);
+	}
+}
+
+
+/**
+ * @description: 按绑核策略排列可用的 CPU
+ * @param {AffinityMode} mode: 绑核策略
+ * @param {vector<int>} &cpus: 显式模式下给定的 CPU 编号，不可用的编号被忽略
+ * @return {vector<int>} CPU 编号，为空表示不绑核
+ */
+std::vector<int> CpuTopology::order(AffinityMode mode, const std::vector<int> &cpus) const {
+	std::vector<int> result;
+
+	if (mode == AffinityMode::EXPLICIT) {
+		for (int cpu : cpus) {
+			for (const Cpu &c : this->m_cpus) {
+				if (c.id == cpu)
+					result.push_back(cpu);
+			}
+		}
+	}
+	else if (mode == AffinityMode::COMPACT) {
+		std::vector<Cpu> sorted(this->m_cpus);
+		std::sort(sorted.begin(), sorted.end(), [](const Cpu &a, const Cpu &b) {
+			return a.node != b.node ? a.node < b.node : (a.core != b.core ? a.core < b.core : a.id < b.id);
+		});
+		for (const Cpu &c : sorted)
+			result.push_back(c.id);
+	}
+	else if (mode == AffinityMode::SCATTER) {
+		// 每个节点内先排各物理核心的第一个 CPU，再排第二个超线程，以此类推
+		std::vector<std::vector<int>> per_node(this->m_nodes);
+		std::vector<std::pair<int, const Cpu *>> ranked;  // (在所属核心中的序号, CPU)
+		for (const Cpu &c : this->m_cpus) {
+			int rank = 0;
+			for (const Cpu &other : this->m_cpus) {
+				if (other.core == c.core && other.id < c.id)
+					++rank;
+			}
+			ranked.push_back(std::make_pair(rank, &c));
+		}
+		std::sort(ranked.begin(), ranked.end(), [](const std::pair<int, const Cpu *> &a, const std::pair<int, const Cpu *> &b) {
+			return a.first != b.first ? a.first < b.first : a.second->id < b.second->id;
+		});
+		for (const std::pair<int, const Cpu *> &r : ranked)
+			per_node[r.second->node].push_back(r.second->id);
+
+		// 各节点轮流取一个
+		for (size_t i = 0; result.size() < this->m_cpus.size(); ++i) {
+			for (const std::vector<int> &node : per_node) {
+				if (i < node.size())
+					result.push_back(node[i]);
+			}
+		}
+	}
+
+	return result;
+}
+
+
+/**
+ * @description: CPU 所属的 NUMA 节点
+ * @param {int} cpu: CPU 编号
+ * @return {int} 节点编号，未知时为 0
+ */
+int CpuTopology::nodeOf(int cpu) const {
+	for (const Cpu &c : this->m_cpus) {
+		if (c.id == cpu)
+			return c.node;
+	}
+	return 0;
+}
+
+
+/**
+ * @description: 将当前线程绑定到指定 CPU
+ * @param {int} cpu: CPU 编号
+ * @return {bool} 是否绑定成功，非 Linux 平台始终失败
+ */
+bool CpuTopology::pinCurrentThread(int cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+
+/**
+ * @description: 解析 sysfs 的 CPU 列表
+ * @param {string} &text: 形如 "0-3,8-11" 的列表
+ * @return {vector<int>} 展开后的编号
+ */
+std::vector<int> CpuTopology::parseCpuList(const std::string &text) {
+	std::vector<int> result;
+	std::stringstream ss(text);
+	std::string range;
+
+	while (std::getline(ss, range, ',')) {
+		int first = 0, last = 0;
+		char dash = 0;
+		std::stringstream rs(range);
+		if (!(rs >> first))
+			continue;
+		if (rs >> dash >> last && dash == '-') {
+			for (int i = first; i <= last; ++i)
+				result.push_back(i);
+		}
+		else {
+			result.push_back(first);
+		}
+	}
+
+	return result;
+}
+
+
+/**
+ * @description: 读取文件的第一行
+ * @param {string} &path: 文件路径
+ * @return {string} 第一行内容，文件不存在时为空
+ */
+std::string CpuTopology::readFile(const std::string &path) {
+	std::ifstream file(path);
+	std::string line;
+	std::getline(file, line);
+	return line;
+}
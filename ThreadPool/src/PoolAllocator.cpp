@@ -0,0 +1,128 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 11:42:18
+ * @last_edit_time: 2026-10-17 11:42:18
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/src/PoolAllocator.cpp
+ * @description: 线程私有的小块内存池源文件
+ */
+
+#include "PoolAllocator.h"
+
+thread_local MemoryPool::FreeList MemoryPool::m_free_lists[MemoryPool::CLASSES];
+thread_local bool MemoryPool::m_exited = false;
+thread_local MemoryPool::Cleaner MemoryPool::m_cleaner;
+
+
+/**
+ * @description: 申请内存，优先从当前线程的空闲链表中取出
+ * @param {size_t} size: 内存大小
+ * @return {void *} 内存地址
+ */
+void *MemoryPool::allocate(size_t size) {
+	if (size == 0 || size > MAX_BLOCK) {
+		return ::operator new(size);
+	}
+
+	size_t level = classOf(size);
+	FreeList &list = m_free_lists[level];
+
+	// 本地链表为空，从全局仓库取回一批
+	if (list.head == nullptr && !m_exited) {
+		Depot &d = depot();
+		std::unique_lock<std::mutex> lock(d.mutex);
+		if (!d.batches[level].empty()) {
+			(void)&m_cleaner;
+			list.head = d.batches[level].back();
+			list.count = BATCH;
+			d.batches[level].pop_back();
+		}
+	}
+
+	if (list.head != nullptr) {
+		Block *block = list.head;
+		list.head = block->next;
+		--list.count;
+		return block;
+	}
+
+	return ::operator new((level + 1) * GRANULARITY);
+}
+
+
+/**
+ * @description: 释放内存，挂到当前线程的空闲链表上
+ * @param {void *} p: 内存地址
+ * @param {size_t} size: 内存大小，需与申请时一致
+ */
+void MemoryPool::deallocate(void *p, size_t size) {
+	if (p == nullptr) {
+		return ;
+	}
+
+	if (size == 0 || size > MAX_BLOCK || m_exited) {
+		::operator delete(p);
+		return ;
+	}
+
+	size_t level = classOf(size);
+	FreeList &list = m_free_lists[level];
+
+	(void)&m_cleaner;  // 首次缓存时构造，保证线程退出时归还内存
+	Block *block = static_cast<Block*>(p);
+	block->next = list.head;
+	list.head = block;
+	++list.count;
+
+	// 本地链表过长，将链表头部的一批归还到全局仓库
+	if (list.count >= MAX_CACHED) {
+		Block *batch = list.head;
+		Block *tail = batch;
+		for (size_t i = 1; i < BATCH; ++i)
+			tail = tail->next;
+		list.head = tail->next;
+		list.count -= BATCH;
+		tail->next = nullptr;
+
+		Depot &d = depot();
+		std::unique_lock<std::mutex> lock(d.mutex);
+		if (d.batches[level].size() < MAX_DEPOT_BATCHES) {
+			d.batches[level].push_back(batch);
+			return ;
+		}
+		lock.unlock();
+
+		while (batch != nullptr) {  // 仓库已满，直接释放
+			Block *next = batch->next;
+			::operator delete(batch);
+			batch = next;
+		}
+	}
+}
+
+
+/**
+ * @description: 获取全局仓库；静态对象析构后仍可能有内存被释放，因此仓库永不析构，内存由进程退出时回收
+ * @return {Depot &} 全局仓库
+ */
+MemoryPool::Depot &MemoryPool::depot() {
+	static Depot *d = new Depot();
+	return *d;
+}
+
+
+/**
+ * @description: 线程退出时释放缓存的全部内存块
+ */
+MemoryPool::Cleaner::~Cleaner() {
+	m_exited = true;
+	for (size_t i = 0; i < CLASSES; ++i) {
+		while (m_free_lists[i].head != nullptr) {
+			Block *block = m_free_lists[i].head;
+			m_free_lists[i].head = block->next;
+			::operator delete(block);
+		}
+		m_free_lists[i].count = 0;
+	}
+}
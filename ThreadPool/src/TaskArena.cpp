@@ -0,0 +1,128 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-17 22:18:40
+ * @last_edit_time: 2026-10-17 22:18:40
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/src/TaskArena.cpp
+ * @description: 工作线程私有的线性分配内存区源文件
+ */
+
+#include "TaskArena.h"
+#include <cstdint>
+
+thread_local TaskArena *TaskArena::m_current = nullptr;
+
+
+/**
+ * @description: 构造函数，首次申请时才分配内存块
+ */
+TaskArena::TaskArena() : m_chunk(0), m_offset(0) { }
+
+
+/**
+ * @description: 析构函数，释放全部内存；若是当前线程的内存区则解除绑定
+ */
+TaskArena::~TaskArena() {
+	if (m_current == this) {
+		m_current = nullptr;
+	}
+	for (char *chunk : this->m_chunks) {
+		::operator delete(chunk);
+	}
+	for (void *p : this->m_large) {
+		::operator delete(p);
+	}
+}
+
+
+/**
+ * @description: 申请内存，当前内存块不足时换到下一块
+ * @param {size_t} size: 字节数
+ * @param {size_t} align: 对齐，须为 2 的幂且不超过 alignof(std::max_align_t)
+ * @return {void *} 内存地址
+ */
+void *TaskArena::allocate(size_t size, size_t align) {
+	if (size > CHUNK_SIZE / 4) {
+		return this->allocateLarge(size);
+	}
+
+	while (true) {
+		if (this->m_chunk < this->m_chunks.size()) {
+			size_t offset = (this->m_offset + align - 1) & ~(align - 1);
+			if (offset + size <= CHUNK_SIZE) {
+				this->m_offset = offset + size;
+				return this->m_chunks[this->m_chunk] + offset;
+			}
+			if (this->m_offset > 0 || this->m_chunk + 1 < this->m_chunks.size()) {  // 换到下一块
+				++this->m_chunk;
+				this->m_offset = 0;
+				continue;
+			}
+		}
+		this->m_chunks.push_back(static_cast<char*>(::operator new(CHUNK_SIZE)));
+		this->m_chunk = this->m_chunks.size() - 1;
+		this->m_offset = 0;
+	}
+}
+
+
+/**
+ * @description: 单独分配大块内存，重置或回退时释放
+ * @param {size_t} size: 字节数
+ * @return {void *} 内存地址
+ */
+void *TaskArena::allocateLarge(size_t size) {
+	this->m_large.reserve(this->m_large.size() + 1);  // 先保证记录成功，避免泄漏
+	void *p = ::operator new(size);
+	this->m_large.push_back(p);
+	return p;
+}
+
+
+/**
+ * @description: 当前位置
+ * @return {Mark} 位置
+ */
+TaskArena::Mark TaskArena::mark() const {
+	return Mark{ this->m_chunk, this->m_offset, this->m_large.size() };
+}
+
+
+/**
+ * @description: 回退到之前的位置
+ * @param {Mark} &m: 由 mark() 取得的位置
+ */
+void TaskArena::rewind(const Mark &m) {
+	this->m_chunk = m.chunk;
+	this->m_offset = m.offset;
+	while (this->m_large.size() > m.large) {
+		::operator delete(this->m_large.back());
+		this->m_large.pop_back();
+	}
+}
+
+
+/**
+ * @description: 回退到起点，只保留 MAX_RETAINED 个内存块
+ */
+void TaskArena::reset() {
+	if (this->m_chunk == 0 && this->m_offset == 0 && this->m_large.empty()) {
+		return ;  // 任务没有使用内存区
+	}
+
+	this->rewind(Mark{ 0, 0, 0 });
+	while (this->m_chunks.size() > MAX_RETAINED) {
+		::operator delete(this->m_chunks.back());
+		this->m_chunks.pop_back();
+	}
+}
+
+
+/**
+ * @description: 已申请的字节数，含对齐填充与内存块末尾的空闲部分
+ * @return {size_t} 字节数
+ */
+size_t TaskArena::used() const {
+	return this->m_chunks.empty() ? 0 : this->m_chunk * CHUNK_SIZE + this->m_offset;
+}
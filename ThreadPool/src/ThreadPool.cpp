@@ -17,6 +17,13 @@
 // 初始线程 ID
 int ThreadPool::m_threads_id = 1;
 
+// 当前线程所属线程池及其下标，只有工作线程会设置
+thread_local ThreadPool *ThreadPool::m_current_pool = nullptr;
+thread_local size_t ThreadPool::m_current_index = 0;
+thread_local std::vector<Task> ThreadPool::m_batch_buffer;
+thread_local bool ThreadPool::m_blocking = false;
+thread_local StatsCounters *ThreadPool::m_current_counters = nullptr;
+
 /**
  * @description: 默认构造函数，线程数量为可用硬件实现支持的并发线程数
  * @description: 通过委托构造函数
@@ -29,37 +36,64 @@ ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency(), Threa
  * @description: 含参构造函数
  * @param {size_t} n_threads: 最低线程数量
  * @param {ThreadPoolWorkMode} work_mode: 线程池工作模式
+ * @param {TaskQueueMode} queue_mode: 任务队列类型，无锁队列的容量即任务量最大值
+ * @param {AffinityMode} affinity: 绑核策略
+ * @param {vector<int>} &cpus: 显式绑核时依次绑定的 CPU 编号
  */
-ThreadPool::ThreadPool(const size_t n_threads, ThreadPoolWorkMode work_mode)
+ThreadPool::ThreadPool(const size_t n_threads, ThreadPoolWorkMode work_mode, TaskQueueMode queue_mode, AffinityMode affinity, const std::vector<int> &cpus)
 	: m_close(false)
-	, m_max_task(2 * n_threads)
 	, m_timeout(std::chrono::milliseconds(3000))
 	, m_priority_level(1)
+	, m_mode(work_mode)
+	, m_queue_mode(queue_mode)
+	, m_max_task(2 * n_threads)
+	, m_waiting_submitters(0)
 	, m_max_threshold(
-		work_mode == ThreadPoolWorkMode::FIXED_THREAD ? 
+		work_mode != ThreadPoolWorkMode::MUTABLE_THREAD ? 
 		(n_threads < std::thread::hardware_concurrency() ? n_threads : std::thread::hardware_concurrency()) : 
 		(2 * n_threads < std::thread::hardware_concurrency() ? 2 * n_threads : std::thread::hardware_concurrency()))
 	, m_min_threshold(
-		work_mode == ThreadPoolWorkMode::FIXED_THREAD ? 
+		work_mode != ThreadPoolWorkMode::MUTABLE_THREAD ? 
 		(n_threads < std::thread::hardware_concurrency() ? n_threads : std::thread::hardware_concurrency()) : 
 		(n_threads < std::thread::hardware_concurrency() ? n_threads : std::thread::hardware_concurrency()))
-	, m_mode(work_mode)
 	, m_thread_amount(0)
+	, m_spin_count(std::thread::hardware_concurrency() > 1 ? 1024 : 0)  // 单核机器上自旋只会挡住提交任务的线程
+	, m_yield_count(16)
+	, m_completed_tasks(0)
+	, m_retire_requests(0)
+	, m_blocked_workers(0)
+	, m_compensating(0)
+	, m_max_compensation(64)
+	, m_pending_tasks(0)
+	, m_idle_workers(0)
+	, m_joiners(0)
+	, m_affinity(affinity)
+	, m_timer_stop(false)
+	, m_timer_wake(UINT64_MAX)
+	, m_timer_epoch(std::chrono::steady_clock::now())
 {
-	std::cout << "线程池初始配置如下: " << std::endl;
-	if (this->m_mode == ThreadPoolWorkMode::FIXED_THREAD)
-		std::cout << "线程池工作模式: FIXED_THREAD"<< std::endl;
+	// 任务量最大值由任务队列自身保证，检查与入队不会被其他提交者打断
+	if (this->m_queue_mode == TaskQueueMode::LOCK_FREE)
+		this->m_task_queue.reset(new LockFreeQueue<Task>(this->m_max_task));
 	else
-		std::cout << "线程池工作模式: MUTABLE_THREAD"<< std::endl;
-	std::cout << "线程数量: " << this->m_min_threshold << '\n'
+		this->m_task_queue.reset(new SafeQueue<Task>());
+	this->m_task_queue->setCapacity(this->m_max_task);
+
+	POOL_TRACE("线程池初始配置如下: " << '\n'
+		<< "线程池工作模式: " << (this->m_mode == ThreadPoolWorkMode::FIXED_THREAD ? "FIXED_THREAD" : 
+			this->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD ? "MUTABLE_THREAD" : "WORK_STEALING") << '\n'
+		<< "线程数量: " << this->m_min_threshold << '\n'
 		<< "线程上限: " << this->m_max_threshold << '\n'
 		<< "线程下限: " << this->m_min_threshold << '\n'
+		<< "任务队列类型: " << (this->m_queue_mode == TaskQueueMode::LOCK_FREE ? "LOCK_FREE" : "PRIORITY") << '\n'
 		<< "任务队列长度: " << this->m_max_task << '\n'
 		<< "任务优先级: " << this->m_priority_level << '\n'
 		<< "任务提交时限: 3 秒\n"
-		<< std::endl;
+		<< "绑核策略: " << (this->m_affinity == AffinityMode::NONE ? "NONE" : this->m_affinity == AffinityMode::COMPACT ? "COMPACT" : 
+			this->m_affinity == AffinityMode::SCATTER ? "SCATTER" : "EXPLICIT") << '\n');
 
 	// 初始化线程池
+	this->initAffinity(cpus);
 	this->initThreadPool();
 }
 
@@ -81,21 +115,38 @@ void ThreadPool::close() {
 		return ;
 	}
 
+	// 先停止定时器线程，尚未到期的定时任务不再执行
+	{
+		std::unique_lock<std::mutex> lock(this->m_timer_mutex);
+		this->m_timer_stop = true;
+	}
+	this->m_timer_condition.notify_all();
+	if (this->m_timer_thread.joinable()) {
+		this->m_timer_thread.join();
+	}
+
 	{
         std::unique_lock<std::mutex> lock(this->m_mutex);
         this->m_close = true;
-		std::cout << "线程池已准备关闭，请勿继续提交任务" << std::endl;
+		POOL_TRACE("线程池已准备关闭，请勿继续提交任务");
     }
 
-	// 唤醒所有被当前条件变量阻塞的线程
+	// 唤醒所有被当前条件变量阻塞的线程，以及等待提交任务的线程
 	this->m_conditional_safe_queue_not_empty.notify_all();
+	this->m_conditional_safe_queue_not_full.notify_all();
+
+	// 先停止控制线程，此后线程队列不再变化
+	this->m_controller_condition.notify_all();
+	if (this->m_controller.joinable()) {
+		this->m_controller.join();
+	}
 
 	// 等待所有线程结束工作
 	for(std::unordered_map<int, std::thread>::iterator it = this->m_threads.begin(); it != this->m_threads.end(); ++it) {
 		it->second.join();
 	}
 
-	std::cout << "线程池已关闭" << std::endl;
+	POOL_TRACE("线程池已关闭");
 }
 
 
@@ -104,13 +155,782 @@ void ThreadPool::close() {
  * @description: 初始化线程池
  */
 void ThreadPool::initThreadPool() {
-	for (int i = 0; i < this->m_min_threshold; ++i) {
-		// std::thread 调用类的成员函数需要传递类的一个对象作为参数， 由于是 operator() 下面两种写法都可以，如果是类内部，传入 this 指针即可
-		// this->m_threads[i] = std::thread(Worker(this, i));  // 分配工作线程
-		this->m_threads[ThreadPool::m_threads_id] = std::thread(&Worker::operator(), Worker(this, ThreadPool::m_threads_id));  // 指定线程所执行的函数
-		ThreadPool::m_threads_id++;
-		this->m_thread_amount++;
+	// 工作窃取模式下，线程启动后即可能窃取任意线程的队列，因此需要先创建全部私有队列
+	if (this->m_mode == ThreadPoolWorkMode::WORK_STEALING) {
+		for (size_t i = 0; i < this->m_min_threshold; ++i) {
+			this->m_local_queues.emplace_back(new WorkStealingQueue<Task>());
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+	for (size_t i = 0; i < this->m_min_threshold; ++i) {
+		this->addThread();
+	}
+
+	// 可变线程模式下，线程的增减全部由控制线程负责，提交任务时不会创建线程
+	if (this->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD) {
+		this->m_control = ControllerState{ 0, 0.0, false, 0, 0 };
+		this->m_controller = std::thread(&ThreadPool::controlThreads, this);
+	}
+}
+
+
+/**
+ * @description: 按绑核策略分配 CPU；工作窃取模式下若有多个 NUMA 节点，按线程绑定的 CPU 给私有队列分组
+ * @param {vector<int>} &cpus: 显式绑核时依次绑定的 CPU 编号
+ */
+void ThreadPool::initAffinity(const std::vector<int> &cpus) {
+	if (this->m_affinity == AffinityMode::NONE) {
+		return ;
+	}
+
+	CpuTopology topology;
+	this->m_worker_cpus = topology.order(this->m_affinity, cpus);
+	if (this->m_worker_cpus.empty()) {
+		std::cerr << "没有可绑定的 CPU，工作线程不绑核" << std::endl;
+		return ;
+	}
+
+	if (this->m_mode != ThreadPoolWorkMode::WORK_STEALING || topology.nodes() < 2) {
+		return ;
+	}
+
+	this->m_node_workers.resize(topology.nodes());
+	for (size_t i = 0; i < this->m_min_threshold; ++i) {
+		int node = topology.nodeOf(this->m_worker_cpus[i % this->m_worker_cpus.size()]);
+		this->m_worker_nodes.push_back(node);
+		this->m_node_workers[node].push_back(i);
+	}
+}
+
+
+/**
+ * @description: 添加一个工作线程，调用者需持有线程池锁
+ */
+void ThreadPool::addThread() {
+	// std::thread 调用类的成员函数需要传递类的一个对象作为参数， 由于是 operator() 下面两种写法都可以，如果是类内部，传入 this 指针即可
+	// this->m_threads[i] = std::thread(Worker(this, i));  // 分配工作线程
+	size_t index = this->m_thread_amount;  // 工作窃取模式下，初始线程的下标与私有队列一一对应
+	if (this->m_mode == ThreadPoolWorkMode::WORK_STEALING && index >= this->m_local_queues.size()) {
+		index = this->m_local_queues.size();  // 补偿线程没有私有队列，只从全局队列取任务或窃取
+	}
+	this->m_threads[ThreadPool::m_threads_id] = std::thread(&Worker::operator(), Worker(this, ThreadPool::m_threads_id, index));  // 指定线程所执行的函数
+	ThreadPool::m_threads_id++;
+	this->m_thread_amount++;
+}
+
+
+/**
+ * @description: 任务入队，任务队列已满时在超时时长内等待
+ * @param {Task} &task: 无参无返回值的任务函数，入队成功后被移走
+ * @return {bool} 入队成功返回 true，提交超时返回 false
+ */
+bool ThreadPool::enqueueTask(Task &task) {
+	return this->enqueueTasks(&task, 1) == 1;
+}
+
+
+/**
+ * @description: 批量任务入队，任务队列已满时在超时时长内等待，工作线程提交时执行其他任务而不等待
+ * @param {Task} *tasks: 任务数组，入队成功的部分被移走
+ * @param {size_t} n: 任务数量
+ * @return {size_t} 成功入队的任务数量，提交超时时少于 n
+ */
+size_t ThreadPool::enqueueTasks(Task *tasks, size_t n) {
+	if (n == 0) {
+		return 0;
+	}
+
+	size_t priority = this->m_priority_level;
+
+	// 先计数再检查关闭标志，保证线程池关闭时不会遗漏已计数的任务
+	this->m_pending_tasks += n;
+
+	StatsCounters &counters = this->localCounters();
+
+	// 如果线程池已经决定关闭，则不可再提交任务
+	if (this->m_close) {
+		this->m_pending_tasks -= n;
+		counters.rejected(n);
+		POOL_TRACE("线程池已被关闭，无法提交新任务");
+		throw std::runtime_error("ThreadPool is already colsed");
+	}
+
+	// 记录入队时刻，用于统计排队时间
+	uint64_t now = statsClock();
+	for (size_t i = 0; i < n; ++i) {
+		tasks[i].stamp(now);
+	}
+
+	// 工作窃取模式下，工作线程提交的任务直接压入自己的私有队列，无需争抢线程池锁
+	if (this->m_mode == ThreadPoolWorkMode::WORK_STEALING && ThreadPool::m_current_pool == this && ThreadPool::m_current_index < this->m_local_queues.size()) {
+		this->m_local_queues[ThreadPool::m_current_index]->pushBatch(tasks, n, priority);
+		counters.submitted(n);
+		this->wakeIdleWorkers(n);
+		return n;
+	}
+
+	// 队列未满时直接入队，无锁队列只需一次 CAS
+	size_t enqueued = this->tryEnqueue(tasks, n, priority);
+	size_t woken = 0;  // 已经唤醒过线程的任务数量
+
+	// 工作线程不能休眠等待队列腾出空间: 队列中的任务可能正在 get() 它提交的子任务，所有工作线程都等待时线程池停滞
+	// 改为在当前线程执行队列中的任务，直到全部入队 (不设超时，分治任务不会因队列已满而被拒绝)
+	if (enqueued < n && this->isWorkerThread()) {
+		this->wakeIdleWorkers(enqueued);
+		woken = enqueued;
+
+		while (enqueued < n && !this->m_close) {
+			if (!this->runPendingTask())
+				std::this_thread::yield();  // 队列中的任务刚被其他线程取走，稍后重试
+			enqueued += this->tryEnqueue(tasks + enqueued, n - enqueued, priority);
+		}
+	}
+
+	if (enqueued < n) {
+		// 已入队的部分先交给休眠的线程，否则批量提交会一直等待队列腾出空间
+		this->wakeIdleWorkers(enqueued - woken);
+		woken = enqueued;
+
+		// 如果任务数已满，等待线程执行
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+		POOL_TRACE("任务队列已满, 请等待任务完成");
+
+		auto deadline = std::chrono::steady_clock::now() + this->m_timeout;
+		bool timeout = false;
+
+		this->m_waiting_submitters++;
+		while (!this->m_close) {
+			enqueued += this->tryEnqueue(tasks + enqueued, n - enqueued, priority);
+			if (enqueued == n || timeout)  // 超时后最后再尝试一次
+				break;
+			if (enqueued > woken && this->m_idle_workers > 0) {  // 已持有线程池锁，直接通知
+				this->m_conditional_safe_queue_not_empty.notify_all();
+				woken = enqueued;
+			}
+			timeout = std::cv_status::timeout == this->m_conditional_safe_queue_not_full.wait_until(lock, deadline);
+		}
+		this->m_waiting_submitters--;
+		lock.unlock();
+
+		if (enqueued < n) {
+			this->m_pending_tasks -= n - enqueued;
+			if (this->m_close) {
+				counters.submitted(enqueued);
+				counters.rejected(n - enqueued);
+				POOL_TRACE("线程池已被关闭，无法提交新任务");
+				throw std::runtime_error("ThreadPool is already colsed");
+			}
+			// 用户提交任务，超过时长，否则算提交任务失败
+			counters.timedOut(n - enqueued);
+			std::cerr << "提交任务超时，请稍后重尝..." << std::endl;
+		}
+	}
+
+	counters.submitted(enqueued);
+
+	// 唤醒等待中的线程
+	this->wakeIdleWorkers(enqueued - woken);
+
+	return enqueued;
+}
+
+
+/**
+ * @description: 尝试提交任务，任务队列已满或线程池已关闭时立即返回，不等待也不抛出异常
+ * @param {Task} &task: 任务，只有提交成功时才会被移走，失败时调用者可以自行执行
+ * @return {bool} true/false
+ */
+bool ThreadPool::tryPost(Task &task) {
+	size_t priority = this->m_priority_level;
+
+	this->m_pending_tasks++;
+	if (this->m_close) {
+		this->m_pending_tasks--;
+		this->localCounters().rejected(1);
+		return false;
+	}
+
+	task.stamp(statsClock());
+	if (this->m_mode == ThreadPoolWorkMode::WORK_STEALING && ThreadPool::m_current_pool == this && ThreadPool::m_current_index < this->m_local_queues.size()) {
+		this->m_local_queues[ThreadPool::m_current_index]->push(std::move(task), priority);
+	}
+	else if (this->tryEnqueue(&task, 1, priority) == 0) {
+		this->m_pending_tasks--;
+		return false;
 	}
+
+	this->localCounters().submitted(1);
+	this->wakeIdleWorker();
+
+	return true;
+}
+
+
+/**
+ * @description: 任务的排队时间
+ * @param {Task} &task: 刚取出的任务
+ * @param {uint64_t} start: 开始执行的时刻 (纳秒)
+ * @return {uint64_t} 排队时间 (纳秒)，未记录入队时刻时为 0
+ */
+static inline uint64_t queueWait(const Task &task, uint64_t start) {
+	uint64_t enqueued = task.stamped();
+	return enqueued != 0 && start > enqueued ? start - enqueued : 0;
+}
+
+
+/**
+ * @description: 执行任务并记录排队时间与执行时间；结束时刻作为连续执行的下一个任务的开始时刻，每个任务只读取一次时钟
+ * @param {Task} &task: 刚取出的任务
+ * @param {uint64_t} start: 开始执行的时刻 (纳秒)，0 表示没有连续执行，需要读取时钟
+ * @param {StatsCounters} &counters: 计数器
+ * @return {uint64_t} 结束时刻 (纳秒)
+ */
+static inline uint64_t runTask(Task &task, uint64_t start, StatsCounters &counters) {
+	if (start == 0) {
+		start = statsClock();
+	}
+	uint64_t wait = queueWait(task, start);
+
+	task();
+
+	uint64_t end = statsClock();
+	counters.executed(wait, end - start);
+	return end;
+}
+
+
+/**
+ * @description: 在当前线程取出并执行一个尚未执行的任务，用于等待其他任务时帮助线程池推进
+ * @return {bool} 执行了任务返回 true，没有可执行的任务返回 false
+ */
+bool ThreadPool::runPendingTask() {
+	Task task;
+
+	if (this->m_mode == ThreadPoolWorkMode::WORK_STEALING) {
+		static thread_local std::minstd_rand rng(std::hash<std::thread::id>()(std::this_thread::get_id()));
+		size_t index = ThreadPool::m_current_pool == this ? ThreadPool::m_current_index : this->m_local_queues.size();
+		if (!this->acquireTask(index, rng, task))
+			return false;
+	}
+	else {
+		if (!this->m_task_queue->taskDequeue(task))
+			return false;
+		this->m_pending_tasks--;
+		this->wakeWaitingSubmitter();
+	}
+
+	// 在任务执行期间被调用 (协作式等待) 时，只回收本任务使用的内存区，外层任务的内存保持有效
+	TaskArena *arena = TaskArena::current();
+	TaskArena::Mark mark = arena ? arena->mark() : TaskArena::Mark();
+
+	runTask(task, 0, this->localCounters());
+	task = nullptr;
+	if (arena) {
+		arena->rewind(mark);
+	}
+	if (this->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD) {  // 协作式等待中执行的任务同样计入吞吐量
+		this->m_completed_tasks.fetch_add(1, std::memory_order_relaxed);
+	}
+	this->notifyJoiners();
+
+	return true;
+}
+
+
+// 可变线程模式的控制参数
+static const std::chrono::milliseconds CONTROL_INTERVAL(50);  // 采样间隔
+static const std::chrono::milliseconds CONTROL_TARGET_WAIT(10);  // 排队时间目标，超过视为积压
+static const double CONTROL_GAIN = 0.05;  // 吞吐量变化超过 5% 才视为有效 (死区)
+static const size_t CONTROL_HOLD_SAMPLES = 20;  // 爬坡无效后暂停的采样次数
+static const size_t CONTROL_SHRINK_SAMPLES = 40;  // 连续空闲多少次采样后减少一个线程
+
+
+/**
+ * @description: 控制线程: 每个采样间隔调整一次线程数量，直到线程池关闭
+ */
+void ThreadPool::controlThreads() {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	while (!this->m_close) {
+		this->m_controller_condition.wait_for(lock, CONTROL_INTERVAL, [this]() { return (bool)this->m_close; });
+		if (this->m_close) {
+			break;
+		}
+		this->adjustThreads();
+	}
+}
+
+
+/**
+ * @description: 爬山法调整线程数量，带迟滞:
+ *               1. 有积压 (按 Little 定律估计的排队时间超过目标) 时逐个增加线程，
+ *                  若上一次增加后吞吐量没有提升超过死区，则暂停爬坡一段时间，吞吐量明显下降时撤回该线程
+ *               2. 没有积压且有空闲线程持续一段时间后，逐个减少线程
+ *               线程数量始终在 [m_min_threshold, m_max_threshold] 之间
+ */
+void ThreadPool::adjustThreads() {
+	ControllerState &c = this->m_control;
+
+	size_t completed = this->m_completed_tasks.load(std::memory_order_relaxed);
+	double seconds = std::chrono::duration<double>(CONTROL_INTERVAL).count();
+	double target = std::chrono::duration<double>(CONTROL_TARGET_WAIT).count();
+	double throughput = (double)(completed - c.last_completed) / seconds;
+	c.last_completed = completed;
+
+	size_t backlog = this->m_pending_tasks;
+	size_t threads = this->m_threads.size() - this->m_retire_requests - this->m_compensating;  // 补偿线程不计入
+	double wait = throughput > 0.0 ? (double)backlog / throughput : (backlog > 0 ? seconds : 0.0);  // 排队时间估计 (秒)
+	bool congested = backlog > 0 && wait > target;
+
+	if (c.hold > 0) {
+		--c.hold;
+	}
+
+	if (congested) {
+		c.idle_samples = 0;
+
+		if (c.climbed && throughput <= c.last_throughput * (1.0 + CONTROL_GAIN)) {
+			if (throughput < c.last_throughput * (1.0 - CONTROL_GAIN) && threads > this->m_min_threshold) {
+				this->m_retire_requests++;
+				this->m_conditional_safe_queue_not_empty.notify_all();
+			}
+			c.hold = CONTROL_HOLD_SAMPLES;
+		}
+
+		c.climbed = false;
+		if (c.hold == 0 && threads < this->m_max_threshold) {
+			this->addThread();
+			c.climbed = true;
+			POOL_TRACE("已动态添加新线程，当前线程数量为: " << this->m_threads.size() << "  ----->   " << this->m_max_threshold);
+		}
+		c.last_throughput = throughput;
+		return ;
+	}
+
+	c.climbed = false;
+	if (backlog == 0 && this->m_idle_workers > this->m_joiners) {  // 协作式等待 (helpUntil) 中的线程也计入 m_idle_workers，但它们在等待结果，不算空闲
+		if (++c.idle_samples >= CONTROL_SHRINK_SAMPLES && threads > this->m_min_threshold) {
+			c.idle_samples = 0;
+			this->m_retire_requests++;
+			this->m_conditional_safe_queue_not_empty.notify_all();
+		}
+	}
+	else {
+		c.idle_samples = 0;
+	}
+}
+
+
+/**
+ * @description: 有退出要求 (控制线程减少线程，或阻塞区域结束后释放补偿线程) 时由当前线程响应，从线程队列中移除自身
+ * @param {int} id: 工作线程 id
+ * @return {bool} 是否需要退出
+ */
+bool ThreadPool::tryRetire(int id) {
+	if (this->m_retire_requests == 0 || this->m_close) {
+		return false;
+	}
+
+	this->m_retire_requests--;
+	this->detachCounters();  // 线程已分离，之后不能再访问线程池
+	this->m_threads[id].detach();
+	this->m_threads.erase(id);
+	this->m_thread_amount--;
+	POOL_TRACE("tid:" << std::this_thread::get_id() << " 退出! ---- 剩余线程: " << this->m_thread_amount);
+
+	return true;
+}
+
+
+/**
+ * @description: 在任务量最大值以内尝试入队，不等待；任务队列按容量拒绝超出的部分，并发提交不会超过最大值
+ * @param {Task} *tasks: 任务数组
+ * @param {size_t} n: 任务数量
+ * @param {size_t} priority: 任务优先级
+ * @return {size_t} 成功入队的任务数量
+ */
+size_t ThreadPool::tryEnqueue(Task *tasks, size_t n, size_t priority) {
+	if (n == 0) {
+		return 0;
+	}
+
+	if (n == 1) {
+		return this->m_task_queue->taskEnqueue(*tasks, priority) ? 1 : 0;
+	}
+
+	return this->m_task_queue->taskEnqueueBatch(tasks, n, priority);
+}
+
+
+/**
+ * @description: 工作窃取模式下获取任务，依次尝试私有队列、全局队列，最后从随机线程开始窃取
+ * @param {size_t} index: 工作线程下标，非工作线程传入私有队列数量，跳过私有队列
+ * @param {minstd_rand} &rng: 工作线程私有的随机数生成器，用于选择窃取对象
+ * @param {Task} &func: 获取任务函数的空函数
+ * @return {bool} true/false
+ */
+bool ThreadPool::acquireTask(size_t index, std::minstd_rand &rng, Task &func) {
+	// 1. 私有队列
+	if (index < this->m_local_queues.size() && this->m_local_queues[index]->pop(func)) {
+		this->m_pending_tasks--;
+		return true;
+	}
+
+	// 2. 全局队列，外部线程提交的任务
+	if (this->m_task_queue->taskDequeue(func)) {
+		this->m_pending_tasks--;
+		this->wakeWaitingSubmitter();  // 通知可以继续提交任务
+		return true;
+	}
+
+	// 3. 多个 NUMA 节点时，先从同一节点上随机的线程开始轮流窃取，避免跨节点访问
+	size_t amount = this->m_local_queues.size();
+	bool grouped = index < this->m_worker_nodes.size();
+	if (grouped) {
+		const std::vector<size_t> &peers = this->m_node_workers[this->m_worker_nodes[index]];
+		size_t start = rng() % peers.size();
+		for (size_t i = 0; i < peers.size(); ++i) {
+			size_t victim = peers[(start + i) % peers.size()];
+			if (victim != index && this->m_local_queues[victim]->steal(func)) {
+				this->m_pending_tasks--;
+				this->localCounters().stolen();
+				return true;
+			}
+		}
+	}
+
+	// 4. 从随机的线程开始，轮流窃取其他 (节点上的) 线程的任务
+	size_t start = rng() % amount;
+	for (size_t i = 0; i < amount; ++i) {
+		size_t victim = (start + i) % amount;
+		if (victim == index || (grouped && this->m_worker_nodes[victim] == this->m_worker_nodes[index])) {
+			continue;
+		}
+		if (this->m_local_queues[victim]->steal(func)) {
+			this->m_pending_tasks--;
+			this->localCounters().stolen();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: 工作线程进入阻塞区域，添加一个补偿线程 (不超过上限)
+ *               仍有尚未退出的多余线程时直接撤回一个退出要求，避免频繁创建和销毁线程
+ */
+void ThreadPool::enterBlocking() {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	this->m_blocked_workers++;
+	if (this->m_close || this->m_compensating >= this->m_max_compensation) {
+		return ;
+	}
+
+	this->m_compensating++;
+	if (this->m_retire_requests > 0) {
+		this->m_retire_requests--;
+	}
+	else {
+		this->addThread();
+	}
+}
+
+
+/**
+ * @description: 工作线程离开阻塞区域，补偿线程多于阻塞中的线程时要求一个线程退出
+ */
+void ThreadPool::leaveBlocking() {
+	std::unique_lock<std::mutex> lock(this->m_mutex);
+
+	this->m_blocked_workers--;
+	if (this->m_compensating > this->m_blocked_workers) {
+		this->m_compensating--;
+		this->m_retire_requests++;
+		this->m_conditional_safe_queue_not_empty.notify_all();
+	}
+}
+
+
+/**
+ * @description: 降低自旋等待的功耗，并让出流水线给同一核心上的另一个超线程
+ */
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield");
+#endif
+}
+
+
+/**
+ * @description: 空闲线程休眠前的自适应等待: 先自旋，再让出时间片，最后才由调用者休眠
+ *               自旋与让出期间线程不计入休眠线程，提交任务时无需通知，省去一次唤醒与上下文切换
+ * @return {bool} 等待期间是否出现了任务
+ */
+bool ThreadPool::spinForTask() {
+	size_t spins = this->m_spin_count.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < spins; ++i) {
+		if (this->m_pending_tasks.load(std::memory_order_relaxed) > 0) {
+			return true;
+		}
+		cpuRelax();
+	}
+
+	size_t yields = this->m_yield_count.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < yields; ++i) {
+		if (this->m_pending_tasks.load(std::memory_order_relaxed) > 0) {
+			return true;
+		}
+		std::this_thread::yield();
+	}
+
+	return false;
+}
+
+
+/**
+ * @description: 有线程休眠时唤醒其中一个，没有则跳过加锁和通知
+ */
+void ThreadPool::wakeIdleWorker() {
+	if (this->m_idle_workers == 0) {
+		return ;
+	}
+
+	// 加锁后再通知，避免线程在检查条件与进入等待之间错过通知
+	{
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+	}
+	this->m_conditional_safe_queue_not_empty.notify_one();
+}
+
+
+/**
+ * @description: 唤醒至多 n 个休眠的线程，没有休眠的线程则跳过加锁和通知
+ * @param {size_t} n: 新提交的任务数量
+ */
+void ThreadPool::wakeIdleWorkers(size_t n) {
+	if (n == 1) {
+		this->wakeIdleWorker();
+		return ;
+	}
+
+	size_t idle = this->m_idle_workers;
+	if (n == 0 || idle == 0) {
+		return ;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+	}
+	if (n >= idle) {
+		this->m_conditional_safe_queue_not_empty.notify_all();
+	}
+	else {
+		for (size_t i = 0; i < n; ++i)
+			this->m_conditional_safe_queue_not_empty.notify_one();
+	}
+}
+
+
+/**
+ * @description: 任务完成后，若有线程在协作式等待中休眠，唤醒它们重新检查等待条件
+ */
+void ThreadPool::notifyJoiners() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);  // 保证先完成任务 (写入结果) 再读取等待数量
+	if (this->m_joiners == 0) {
+		return ;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+	}
+	this->m_conditional_safe_queue_not_empty.notify_all();
+}
+
+
+/**
+ * @description: 当前线程应写入的计数器: 本线程池的工作线程写自己的计数器，其他线程写共用的计数器
+ * @return {StatsCounters &} 计数器
+ */
+StatsCounters &ThreadPool::localCounters() {
+	if (ThreadPool::m_current_pool == this && ThreadPool::m_current_counters != nullptr) {
+		return *ThreadPool::m_current_counters;
+	}
+	return this->m_stats.external();
+}
+
+
+/**
+ * @description: 工作线程退出前注销自己的计数器，计数并入已退出线程的合计
+ */
+void ThreadPool::detachCounters() {
+	if (ThreadPool::m_current_counters != nullptr) {
+		this->m_stats.detach(ThreadPool::m_current_counters);
+		ThreadPool::m_current_counters = nullptr;
+	}
+}
+
+
+/**
+ * @description: 运行统计快照，逐个读取各线程的计数器，不会暂停工作线程
+ * @return {ThreadPoolStats} 快照
+ */
+ThreadPoolStats ThreadPool::stats() {
+	return this->m_stats.snapshot();
+}
+
+
+/**
+ * @description: 添加定时器，首次添加时启动定时器线程；到期时间早于定时器线程计划醒来的时间时唤醒它
+ * @param {TimerTask} &&timer: 定时器
+ * @param {duration} delay: 延迟时长
+ * @return {TimerId} 定时任务编号
+ */
+ThreadPool::TimerId ThreadPool::addTimer(TimerTask &&timer, std::chrono::steady_clock::duration delay) {
+	std::unique_lock<std::mutex> lock(this->m_timer_mutex);
+
+	if (this->m_close || this->m_timer_stop) {
+		POOL_TRACE("线程池已被关闭，无法提交新任务");
+		throw std::runtime_error("ThreadPool is already colsed");
+	}
+
+	if (!this->m_timer_thread.joinable()) {
+		this->m_timer_thread = std::thread(&ThreadPool::timerLoop, this);
+	}
+
+	// 当前刻度加上向上取整的延迟，保证定时任务不会提前执行
+	uint64_t expire = this->currentTick() + 1 + ThreadPool::ticksOf(delay);
+	TimerId id = this->m_timer_wheel.add(expire, std::move(timer));
+
+	if (expire < this->m_timer_wake) {
+		this->m_timer_condition.notify_one();
+	}
+
+	return id;
+}
+
+
+/**
+ * @description: 取消定时任务；周期任务已提交到线程池的那一次仍会执行
+ * @param {TimerId} id: 定时任务编号
+ * @return {bool} 是否取消成功
+ */
+bool ThreadPool::cancel_timer(TimerId id) {
+	std::unique_lock<std::mutex> lock(this->m_timer_mutex);
+
+	return this->m_timer_wheel.cancel(id);
+}
+
+
+/**
+ * @description: 获取尚未到期的定时任务数量
+ * @return {size_t} 定时任务数量
+ */
+size_t ThreadPool::getTimersAmount() {
+	std::unique_lock<std::mutex> lock(this->m_timer_mutex);
+
+	return this->m_timer_wheel.size();
+}
+
+
+/**
+ * @description: 定时器线程: 推进时间轮并提交到期任务，然后休眠到下一个需要处理的刻度
+ */
+void ThreadPool::timerLoop() {
+	std::unique_lock<std::mutex> lock(this->m_timer_mutex);
+
+	while (!this->m_timer_stop) {
+		uint64_t now = this->currentTick();
+		this->m_timer_wheel.advance(now, [this, now](TimerTask &timer, uint64_t expire) {
+			return this->fireTimer(timer, expire, now);
+		});
+
+		this->m_timer_wake = this->m_timer_wheel.nextTick();
+		if (this->m_timer_wake == UINT64_MAX) {
+			this->m_timer_condition.wait(lock);
+		}
+		else {
+			this->m_timer_condition.wait_until(lock, this->m_timer_epoch + std::chrono::milliseconds(this->m_timer_wake));
+		}
+	}
+}
+
+
+/**
+ * @description: 定时器到期，将任务提交到线程池；不阻塞定时器线程，任务队列已满时下一刻度重试
+ * @param {TimerTask} &timer: 定时器
+ * @param {uint64_t} expire: 本次到期刻度
+ * @param {uint64_t} now: 当前刻度
+ * @return {uint64_t} 0 表示定时器结束，否则为下一次到期的刻度
+ */
+uint64_t ThreadPool::fireTimer(TimerTask &timer, uint64_t expire, uint64_t now) {
+	if (!timer.periodic) {
+		return this->tryPost(timer.job) ? 0 : now + 1;
+	}
+
+	if (!timer.periodic->running.exchange(true)) {
+		Task run(PeriodicRun{ timer.periodic });
+		if (!this->tryPost(run)) {
+			timer.periodic->running = false;
+		}
+	}
+
+	// 按固定频率计时，落后时跳过错过的周期
+	uint64_t next = expire + timer.period;
+	if (next <= now) {
+		next += ((now - next) / timer.period + 1) * timer.period;
+	}
+
+	return next;
+}
+
+
+/**
+ * @description: 当前时间对应的刻度，向下取整
+ * @return {uint64_t} 刻度
+ */
+uint64_t ThreadPool::currentTick() const {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->m_timer_epoch).count();
+}
+
+
+/**
+ * @description: 时长对应的刻度数，向上取整，负数视为 0
+ * @param {duration} d: 时长
+ * @return {uint64_t} 刻度数
+ */
+uint64_t ThreadPool::ticksOf(std::chrono::steady_clock::duration d) {
+	if (d.count() <= 0) {
+		return 0;
+	}
+
+	std::chrono::milliseconds ticks = std::chrono::duration_cast<std::chrono::milliseconds>(d);
+	if (ticks < d) {
+		++ticks;
+	}
+
+	return (uint64_t)ticks.count();
+}
+
+
+/**
+ * @description: 有提交者因任务队列已满而等待时唤醒它们，没有则跳过加锁和通知
+ */
+void ThreadPool::wakeWaitingSubmitter() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);  // 保证先完成出队再读取等待数量
+	if (this->m_waiting_submitters == 0) {
+		return ;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->m_mutex);
+	}
+	this->m_conditional_safe_queue_not_full.notify_all();
 }
 
 
@@ -124,10 +944,12 @@ void ThreadPool::initThreadPool() {
  * @description: 工作线程构造函数
  * @param {ThreadPool} *pool: 工作线程所属线程池
  * @param {int} id: 工作线程 ID
+ * @param {size_t} index: 工作线程下标，工作窃取模式下对应私有队列
  */
-ThreadPool::Worker::Worker(ThreadPool *pool, const int id) 
+ThreadPool::Worker::Worker(ThreadPool *pool, const int id, const size_t index) 
 	: m_pool(pool)
 	, m_id(id)
+	, m_index(index)
 { }
 
 
@@ -135,56 +957,169 @@ ThreadPool::Worker::Worker(ThreadPool *pool, const int id)
  * @description: 重载 ()，这里是工作线程的工作函数，提交的函数会在这里执行
  */
 void ThreadPool::Worker::operator()() {
-	std::function<void()> func;  // 存放真正执行的函数
-	bool dequeued = false;  // 是否取出任务
+	ThreadPool::m_current_pool = this->m_pool;
+	ThreadPool::m_current_index = this->m_index;
+
+	if (!this->m_pool->m_worker_cpus.empty()) {
+		CpuTopology::pinCurrentThread(this->m_pool->m_worker_cpus[this->m_index % this->m_pool->m_worker_cpus.size()]);
+	}
+
+	// 工作线程私有的内存区，绑核之后才申请内存，内存位于线程所在的 NUMA 节点
+	TaskArena arena;
+	TaskArena::bind(&arena);
+
+	// 工作线程私有的计数器，执行任务时只写自己的缓存行
+	StatsCounters counters;
+	ThreadPool::m_current_counters = &counters;
+	this->m_pool->m_stats.attach(&counters);
+
+	if (this->m_pool->m_mode == ThreadPoolWorkMode::WORK_STEALING) {
+		this->workStealing();
+		if (ThreadPool::m_current_counters != nullptr) {  // 响应退出要求的线程已在 tryRetire 中注销，线程池可能已析构
+			this->m_pool->detachCounters();
+		}
+		return ;
+	}
 
-	while (!this->m_pool->m_close || !this->m_pool->m_task_queue.empty()) {
-		{
-			// 线程池加锁
+	Task func;  // 存放真正执行的函数
+	bool mutable_mode = this->m_pool->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD;
+	auto has_task = [this]() {  // 休眠的唤醒条件，还包括线程的退出要求
+		return this->m_pool->m_close || this->m_pool->m_pending_tasks > 0 || this->m_pool->m_retire_requests > 0;
+	};
+	uint64_t now = 0;  // 上一个任务的结束时刻，连续取到任务时作为下一个任务的开始时刻
+
+	while (true) {
+		// 要求减少线程时，由执行完当前任务的线程响应
+		if (this->m_pool->m_retire_requests > 0) {
 			std::unique_lock<std::mutex> lock(this->m_pool->m_mutex);
+			if (this->m_pool->tryRetire(this->m_id)) {
+				return ;
+			}
+		}
+
+		// 任务队列自身保证线程安全，取任务无需线程池加锁
+		if (this->m_pool->m_task_queue->taskDequeue(func)) {
+			this->m_pool->m_pending_tasks--;
 
-			std::cout << "tid: " << std::this_thread::get_id() << " 正在尝试获取任务" << std::endl;
-
-			// 如果任务队列为空，阻塞当前线程
-			if (this->m_pool->m_task_queue.empty()) {
-				std::cout << "任务队列空，等待任务..." << std::endl;
-				if (this->m_pool->m_mode == ThreadPoolWorkMode::FIXED_THREAD) {
-					this->m_pool->m_conditional_safe_queue_not_empty.wait(lock);  // 等待任务
-				}
-				else if (this->m_pool->m_mode == ThreadPoolWorkMode::MUTABLE_THREAD) {
-					
-					if (std::cv_status::timeout == this->m_pool->m_conditional_safe_queue_not_empty.wait_for(
-						lock, std::chrono::milliseconds(this->m_pool->m_timeout))) {
-						
-						if (this->m_pool->m_thread_amount > this->m_pool->m_min_threshold) {
-							std::cout << "tid:" << std::this_thread::get_id() << " 退出! ---- ";
-							this->m_pool->m_threads[this->m_id].detach();
-							this->m_pool->m_threads.erase(this->m_id);
-							this->m_pool->m_thread_amount--;
-							std::cout << "剩余线程: " << this->m_pool->m_thread_amount << std::endl;
-							return ;
-						}
-						else {
-							this->m_pool->m_conditional_safe_queue_not_empty.wait(lock);  // 等待任务
-						}
-					}
-				}
+			// 取出一个任务进行通知 通知可以继续提交任务
+			this->m_pool->wakeWaitingSubmitter();
+			POOL_TRACE("tid: " << std::this_thread::get_id() << " 已领取任务，当前任务数量为: " << this->m_pool->m_task_queue->safeQueueSize() 
+				<< "  ----->   " << this->m_pool->m_max_task);
+			now = runTask(func, now, counters);
+			func = nullptr;  // 及时释放任务持有的资源
+			arena.reset();  // 回收任务使用的内存区
+			if (mutable_mode) {
+				this->m_pool->m_completed_tasks.fetch_add(1, std::memory_order_relaxed);
 			}
+			this->m_pool->notifyJoiners();
+			continue;
+		}
+		now = 0;  // 之后可能自旋或休眠，下一个任务重新读取时钟
 
-			// 取出任务队列中的元素
-			dequeued = this->m_pool->m_task_queue.taskDequeue(func);
+		// 休眠前先自旋等待一段时间，期间有新任务则直接领取
+		if (this->m_pool->spinForTask()) {
+			continue;
 		}
 
-		// 如果成功取出，执行工作函数
-		if (dequeued) {
-			// 取出一个任务进行通知 通知可以继续提交任务
-			this->m_pool->m_conditional_safe_queue_not_full.notify_all();
-			std::cout << "tid: " << std::this_thread::get_id() << " 已领取任务，当前任务数量为: " << this->m_pool->m_task_queue.safeQueueSize() 
-				<< "  ----->   " << this->m_pool->m_max_task << std::endl;
-			func();
+		// 线程池加锁
+		std::unique_lock<std::mutex> lock(this->m_pool->m_mutex);
+
+		// 线程池已关闭且没有剩余任务，退出
+		if (this->m_pool->m_close && this->m_pool->m_pending_tasks == 0) {
+			break;
 		}
-		else {
-			std::cout << "tid: " << std::this_thread::get_id() << " 取出任务失败" << std::endl;
+
+		// 如果任务队列为空，阻塞当前线程
+		POOL_TRACE("任务队列空，等待任务...");
+		this->m_pool->m_idle_workers++;
+		this->m_pool->m_conditional_safe_queue_not_empty.wait(lock, has_task);  // 等待任务
+		this->m_pool->m_idle_workers--;
+
+		// 要求减少线程，释放线程
+		if (this->m_pool->tryRetire(this->m_id)) {
+			return ;
 		}
 	}
-}
\ No newline at end of file
+
+	this->m_pool->detachCounters();
+}
+
+
+/**
+ * @description: 工作窃取模式下的工作函数，没有任何任务可取时才会休眠
+ */
+void ThreadPool::Worker::workStealing() {
+	std::minstd_rand rng(this->m_id);  // 选择窃取对象的随机数生成器
+	Task func;  // 存放真正执行的函数
+	bool compensating = this->m_index >= this->m_pool->m_local_queues.size();  // 补偿线程没有私有队列，只有它们会响应退出要求
+	TaskArena *arena = TaskArena::current();  // 工作线程私有的内存区
+	StatsCounters &counters = *ThreadPool::m_current_counters;  // 工作线程私有的计数器
+	uint64_t now = 0;  // 上一个任务的结束时刻，连续取到任务时作为下一个任务的开始时刻
+
+	while (true) {
+		if (compensating && this->m_pool->m_retire_requests > 0) {
+			std::unique_lock<std::mutex> lock(this->m_pool->m_mutex);
+			if (this->m_pool->tryRetire(this->m_id)) {
+				return ;
+			}
+		}
+
+		if (this->m_pool->acquireTask(this->m_index, rng, func)) {
+			now = runTask(func, now, counters);
+			func = nullptr;  // 及时释放任务持有的资源
+			arena->reset();  // 回收任务使用的内存区
+			this->m_pool->notifyJoiners();
+			continue;
+		}
+		now = 0;  // 之后可能自旋或休眠，下一个任务重新读取时钟
+
+		if (this->m_pool->spinForTask()) {
+			continue;
+		}
+
+		// 没有可取的任务，休眠等待，直到有新任务或线程池关闭
+		std::unique_lock<std::mutex> lock(this->m_pool->m_mutex);
+		this->m_pool->m_idle_workers++;
+		this->m_pool->m_conditional_safe_queue_not_empty.wait(lock, [this, compensating]() {
+			return this->m_pool->m_close || this->m_pool->m_pending_tasks > 0 || (compensating && this->m_pool->m_retire_requests > 0);
+		});
+		this->m_pool->m_idle_workers--;
+
+		if (compensating && this->m_pool->tryRetire(this->m_id)) {
+			return ;
+		}
+
+		if (this->m_pool->m_close && this->m_pool->m_pending_tasks == 0) {
+			break;
+		}
+	}
+}
+
+
+
+/*
+***************************阻塞区域的实现***************************
+*/
+
+/**
+ * @description: 进入阻塞区域，只在工作线程中且未嵌套时生效
+ */
+ThreadPool::blocking_region::blocking_region() 
+	: m_pool(ThreadPool::m_blocking ? nullptr : ThreadPool::m_current_pool)
+{
+	if (this->m_pool) {
+		ThreadPool::m_blocking = true;
+		this->m_pool->enterBlocking();
+	}
+}
+
+
+/**
+ * @description: 离开阻塞区域
+ */
+ThreadPool::blocking_region::~blocking_region() {
+	if (this->m_pool) {
+		this->m_pool->leaveBlocking();
+		ThreadPool::m_blocking = false;
+	}
+}
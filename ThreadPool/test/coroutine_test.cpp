@@ -0,0 +1,103 @@
+/**
+ * @author: yuyuyuj1e 807152541@qq.com
+ * @github: https://github.com/yuyuyuj1e
+ * @csdn: https://blog.csdn.net/yuyuyuj1e
+ * @date: 2026-10-18 03:12:26
+ * @last_edit_time: 2026-10-18 03:12:26
+ * @file_path: /Tiny-Cpp-Frame/ThreadPool/test/coroutine_test.cpp
+ * @description: 线程池协程测试文件 (C++20): 恢复位置、子协程、co_await PoolFuture 与异常传递
+ */
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "ThreadPool.h"
+#include "PoolFuture.h"
+#include "PoolCoroutine.h"
+
+// 子协程，被 co_await 时在等待者的线程中执行
+coro::task<int> increment(int x) {
+	co_return x + 1;
+}
+
+// 子协程抛出异常
+coro::task<int> fail() {
+	throw std::logic_error("coroutine");
+	co_return 0;
+}
+
+// co_await pool.schedule() 之后在工作线程中恢复
+coro::task<bool> resumedOnWorker(ThreadPool &pool) {
+	co_await pool.schedule();
+	co_return pool.isWorkerThread();
+}
+
+// 依次等待子协程与线程池 future
+coro::task<int> chain(ThreadPool &pool, int n) {
+	int value = 0;
+	for (int i = 0; i < n; ++i) {
+		value = co_await increment(value);
+		co_await pool.schedule();
+	}
+	value += co_await pool.async([]() { return 100; });
+	co_return value;
+}
+
+// 子协程的异常在 co_await 处重新抛出，可以在协程内捕获
+coro::task<int> catchInside() {
+	try {
+		co_await fail();
+	}
+	catch (const std::logic_error &) {
+		co_return -1;
+	}
+	co_return 0;
+}
+
+
+int main() {
+	ThreadPool pool(2, ThreadPoolWorkMode::FIXED_THREAD, TaskQueueMode::LOCK_FREE);
+
+	// 恢复位置
+	assert(!pool.isWorkerThread());
+	assert(coro::spawn(pool, resumedOnWorker(pool)).get());
+
+	// 子协程与 PoolFuture
+	assert(coro::spawn(pool, chain(pool, 1000)).get() == 1100);
+
+	// 大量协程同时在线程池中切换
+	std::vector<PoolFuture<int>> futures;
+	for (int i = 0; i < 64; ++i) {
+		futures.push_back(coro::spawn(pool, chain(pool, 100)));
+	}
+	for (PoolFuture<int> &f : futures) {
+		assert(f.get() == 200);
+	}
+
+	// 异常: 协程内捕获，或经 spawn 的 future 在 get() 时重新抛出
+	assert(coro::spawn(pool, catchInside()).get() == -1);
+	bool thrown = false;
+	try {
+		coro::spawn(pool, fail()).get();
+	}
+	catch (const std::logic_error &) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	// 线程池已关闭: 切换失败的异常写入 future，而不是终止程序
+	pool.close();
+	thrown = false;
+	try {
+		coro::spawn(pool, increment(1)).get();
+	}
+	catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	std::cout << "协程: 通过" << std::endl;
+	return 0;
+}
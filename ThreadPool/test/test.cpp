@@ -8,8 +8,15 @@
  * @description: 线程池测试文件
  */
 
+#include <algorithm>
+#include <cassert>
 #include <iostream>
+#include <numeric>
+#include <random>
 #include "ThreadPool.h"
+#include "ExecutorGroup.h"
+#include "ParallelAlgorithms.h"
+#include "Strand.h"
 
 // 普通函数
 void multiply(const int a, const int b) {
@@ -34,7 +41,891 @@ int multiply_return(const int a, const int b) {
 }
 
 
+/*
+***************************行为测试***************************
+*/
+
+// 分治: 在工作线程中提交子任务并 get() 等待
+int fib(ThreadPool &pool, int n) {
+	if (n < 2)
+		return n;
+	auto left = pool.submitTask(fib, std::ref(pool), n - 1);
+	int right = fib(pool, n - 2);
+	return pool.get(left) + right;
+}
+
+// 默认设置 (任务量最大值为线程数的 2 倍) 下嵌套提交，任务队列已满时工作线程不能阻塞等待
+void testNestedGet() {
+	const TaskQueueMode modes[] = { TaskQueueMode::PRIORITY, TaskQueueMode::LOCK_FREE };
+	for (TaskQueueMode mode : modes) {
+		ThreadPool pool(4, ThreadPoolWorkMode::FIXED_THREAD, mode);
+		auto result = pool.submitTask(fib, std::ref(pool), 18);
+		assert(result.get() == 2584);
+		assert(pool.stats().timed_out == 0);
+	}
+	std::cout << "嵌套 get(): 通过" << std::endl;
+}
+
+// 任务队列已满时工作线程中的批量提交会执行等待中的任务，其中的任务再次批量提交 (同一线程重入 submitBatch)
+void testNestedBatch() {
+	const TaskQueueMode modes[] = { TaskQueueMode::PRIORITY, TaskQueueMode::LOCK_FREE };
+	for (TaskQueueMode mode : modes) {
+		ThreadPool pool(2, ThreadPoolWorkMode::FIXED_THREAD, mode);
+		assert(pool.setTaskMaxAmount(4));
+
+		const int outer = 64, inner = 16;
+		std::atomic<int> done(0);
+		auto root = pool.submitTask([&pool, &done, outer, inner]() {
+			std::vector<std::function<void()>> batch;
+			for (int i = 0; i < outer; ++i) {
+				batch.push_back([&pool, &done, inner]() {
+					std::vector<std::function<void()>> leaves(inner, [&done]() { done++; });
+					assert(pool.submitBatch(leaves) == (size_t)inner);
+					done++;
+				});
+			}
+			assert(pool.submitBatch(batch) == (size_t)outer);
+		});
+		root.get();
+
+		while (done < outer * (inner + 1)) {
+			std::this_thread::yield();
+		}
+		assert(pool.stats().timed_out == 0);
+	}
+	std::cout << "嵌套批量提交: 通过" << std::endl;
+}
+
+// 工作窃取: 一个工作线程把子任务压入自己的私有队列后忙等 (不协作执行)，子任务只能由其他线程窃取完成
+void testWorkStealing() {
+	ThreadPool pool(4, ThreadPoolWorkMode::WORK_STEALING);
+	if (pool.getThreadsAmount() < 2) {
+		std::cout << "工作窃取: 跳过 (只有一个工作线程)" << std::endl;
+		return ;
+	}
+
+	const int amount = 1000;
+	std::atomic<int> done(0);
+	auto root = pool.submitTask([&pool, &done, amount]() {
+		for (int i = 0; i < amount; ++i) {
+			pool.post([&done]() { done++; });
+		}
+		while (done < amount) {
+			std::this_thread::yield();
+		}
+	});
+	root.get();
+
+	assert(done == amount);
+	ThreadPoolStats stats = pool.stats();
+	assert(stats.stolen > 0);
+	assert(stats.submitted == amount + 1);
+
+	// 分治结果与串行一致
+	auto result = pool.submitTask(fib, std::ref(pool), 20);
+	assert(result.get() == 6765);
+	std::cout << "工作窃取: 通过" << std::endl;
+}
+
+// 无锁队列: 达到上限时入队失败；多个生产者与消费者并发读写时，每个元素恰好取出一次
+void testLockFreeQueue() {
+	const size_t producers = 4, consumers = 4, per_producer = 20000;
+	// 未调用 setCapacity 时上限即容量
+	LockFreeQueue<int> fresh(8);
+	int fill[9] = { 0 };
+	assert(fresh.taskEnqueueBatch(fill, 6, 0) == 6);
+	assert(fresh.taskEnqueue(fill[6], 0) && fresh.taskEnqueue(fill[7], 0));
+	assert(!fresh.taskEnqueue(fill[8], 0));
+	assert(fresh.safeQueueSize() == 8);
+	for (int i = 0; i < 8; ++i) {
+		assert(fresh.taskDequeue(fill[i]));
+	}
+	assert(fresh.empty());
+
+	LockFreeQueue<int> queue(64);
+	assert(!queue.setCapacity(65));
+	assert(queue.setCapacity(32));
+
+	int values[40] = { 0 };
+	assert(queue.taskEnqueueBatch(values, 40, 0) == 32);
+	assert(!queue.taskEnqueue(values[0], 0));
+	for (int i = 0; i < 32; ++i) {
+		assert(queue.taskDequeue(values[i]));
+	}
+	assert(!queue.taskDequeue(values[0]));
+
+	std::vector<std::atomic<int>> seen(producers * per_producer);
+	for (std::atomic<int> &s : seen) {
+		s = 0;
+	}
+	std::atomic<size_t> consumed(0);
+
+	std::vector<std::thread> threads;
+	for (size_t p = 0; p < producers; ++p) {
+		threads.emplace_back([&queue, p, per_producer]() {
+			for (size_t i = 0; i < per_producer; ) {
+				int value = (int)(p * per_producer + i);
+				size_t n = i % 3 == 0 && i + 2 < per_producer ? 2 : 1;  // 交替单个与批量入队
+				int batch[2] = { value, value + 1 };
+				size_t pushed = n == 1 ? (queue.taskEnqueue(batch[0], 0) ? 1 : 0) : queue.taskEnqueueBatch(batch, n, 0);
+				if (pushed == 0)
+					std::this_thread::yield();
+				i += pushed;
+			}
+		});
+	}
+	for (size_t c = 0; c < consumers; ++c) {
+		threads.emplace_back([&]() {
+			int value;
+			while (consumed < producers * per_producer) {
+				if (queue.taskDequeue(value)) {
+					seen[value]++;
+					consumed++;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread &t : threads) {
+		t.join();
+	}
+
+	assert(queue.empty());
+	for (std::atomic<int> &s : seen) {
+		assert(s == 1);
+	}
+
+	// 线程池提交: 任务量最大值在并发提交时同样有效
+	ThreadPool pool(1, ThreadPoolWorkMode::FIXED_THREAD, TaskQueueMode::LOCK_FREE);
+	assert(!pool.setTaskMaxAmount(pool.getTaskMaxAmount() + 1));
+	assert(pool.setTaskMaxAmount(2));
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	pool.post([blocked]() { blocked.wait(); });
+	while (pool.getPendingTasksAmount() > 0) {
+		std::this_thread::yield();
+	}
+
+	std::atomic<int> accepted(0);
+	std::vector<std::thread> submitters;
+	for (int i = 0; i < 8; ++i) {
+		submitters.emplace_back([&pool, &accepted]() {
+			for (int k = 0; k < 100; ++k) {
+				Task task([]() { });
+				if (pool.tryPost(task))
+					accepted++;
+			}
+		});
+	}
+	for (std::thread &t : submitters) {
+		t.join();
+	}
+	assert(accepted == 2);
+	gate.set_value();
+	std::cout << "无锁队列: 通过" << std::endl;
+}
+
+// 线程池 future: then 串联结果，异常跳过后续的续延；任务队列已满时续延在完成任务的线程中直接执行；
+// when_all 收集全部结果 (含异常)，when_any 给出最先就绪的下标
+void testFutureCombinators() {
+	ThreadPool pool(2);
+	pool.setTaskMaxAmount(16);
+
+	// 串联
+	auto chained = pool.async([]() { return 2; })
+		.then([](int x) { return x * 3; })
+		.then([](int x) { return std::to_string(x) + "!"; });
+	assert(chained.get() == "6!");
+	std::atomic<int> stages(0);
+	auto void_chain = pool.async([&stages]() { stages++; })
+		.then([&stages]() { stages++; return 1; })
+		.then([&stages](int x) { stages += x; });
+	void_chain.get();
+	assert(stages == 3);
+
+	// 异常跳过续延，传递到最后一个阶段
+	std::atomic<int> skipped(0);
+	auto failed = pool.async([]() -> int { throw std::runtime_error("stage"); })
+		.then([&skipped](int x) { skipped++; return x; })
+		.then([&skipped](int x) { skipped++; return x; });
+	bool thrown = false;
+	try {
+		failed.get();
+	}
+	catch (const std::runtime_error &e) {
+		thrown = std::string(e.what()) == "stage";
+	}
+	assert(thrown && skipped == 0);
+
+	// 任务队列已满: 续延不入队，在完成上一阶段的线程中紧接着执行
+	{
+		ThreadPool single(1);
+		assert(single.setTaskMaxAmount(1));
+		std::promise<void> gate;
+		std::shared_future<void> blocked = gate.get_future().share();
+		std::atomic<bool> started(false), queued_ran(false);
+		auto first = single.async([blocked, &started]() { started = true; blocked.wait(); return 5; });
+		while (!started) {
+			std::this_thread::yield();
+		}
+		assert(single.post([&queued_ran]() { queued_ran = true; }));  // 占满任务队列
+		auto next = first.then([&single, &queued_ran](int x) {
+			assert(single.isWorkerThread());
+			return queued_ran ? -1 : x + 1;  // 入队的续延只能在排队的任务之后执行
+		});
+		gate.set_value();
+		assert(next.get() == 6);
+	}
+
+	// when_all: 值与异常混合
+	std::vector<PoolFuture<int>> all;
+	for (int i = 0; i < 8; ++i) {
+		all.push_back(pool.async([i]() -> int {
+			if (i % 3 == 2)
+				throw std::logic_error("odd one");
+			return i * i;
+		}));
+	}
+	std::vector<PoolFuture<int>> collected = when_all(all).get();
+	assert(collected.size() == 8);
+	for (int i = 0; i < 8; ++i) {
+		assert(collected[i].ready());
+		if (i % 3 == 2) {
+			bool logic = false;
+			try {
+				collected[i].get();
+			}
+			catch (const std::logic_error &) {
+				logic = true;
+			}
+			assert(logic);
+		}
+		else {
+			assert(collected[i].get() == i * i);
+		}
+	}
+	std::vector<PoolFuture<int>> none;
+	assert(when_all(none).get().empty());
+
+	// when_any: 只有下标为 2 的任务可以完成；它最先提交，单个工作线程时也不会被等待的任务挡住
+	std::promise<void> release;
+	std::shared_future<void> held = release.get_future().share();
+	std::vector<PoolFuture<int>> any(4);
+	any[2] = pool.async([]() { return 2; });
+	for (int i = 0; i < 4; ++i) {
+		if (i != 2)
+			any[i] = pool.async([i, held]() { held.wait(); return i; });
+	}
+	WhenAnyResult<PoolFuture<int>> first = when_any(any).get();
+	assert(first.index == 2);
+	assert(first.futures.size() == 4 && first.futures[2].get() == 2);
+	release.set_value();
+	for (int i = 0; i < 4; ++i) {
+		if (i != 2)
+			assert(first.futures[i].get() == i);
+	}
+	assert(when_any(none).get().index == size_t(-1));
+	std::cout << "future 组合: 通过" << std::endl;
+}
+
+// 并行算法: 结果与串行算法一致，任务抛出的异常在调用处重新抛出
+void testParallelAlgorithms() {
+	const ThreadPoolWorkMode modes[] = { ThreadPoolWorkMode::FIXED_THREAD, ThreadPoolWorkMode::WORK_STEALING };
+	for (ThreadPoolWorkMode mode : modes) {
+		ThreadPool pool(4, mode);
+
+		std::vector<int> squares(100000);
+		parallel_for(pool, 0, (int)squares.size(), [&squares](int i) { squares[i] = i % 1000 * (i % 1000); });
+		for (int i = 0; i < (int)squares.size(); ++i) {
+			assert(squares[i] == i % 1000 * (i % 1000));
+		}
+
+		long long sum = parallel_reduce(pool, squares.begin(), squares.end(), 0LL);
+		assert(sum == std::accumulate(squares.begin(), squares.end(), 0LL));
+
+		std::vector<int> data(200000);
+		std::mt19937 rng(20261017);
+		for (int &x : data) {
+			x = (int)(rng() % 100000);
+		}
+		std::vector<int> expected(data);
+		std::sort(expected.begin(), expected.end());
+		parallel_sort(pool, data.begin(), data.end());
+		assert(data == expected);
+
+		bool thrown = false;
+		try {
+			parallel_for(pool, 0, 10000, [](int i) {
+				if (i == 7777)
+					throw std::logic_error("parallel_for");
+			});
+		}
+		catch (const std::logic_error &) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+	std::cout << "并行算法: 通过" << std::endl;
+}
+
+// 时间轮: 各层的定时器都在到期刻度触发 (跨层的需要级联)，取消的不触发，周期定时器按返回值重新计时
+void testTimerWheel() {
+	TimerWheel<uint64_t> wheel;
+	const uint64_t expires[] = { 1, 5, 255, 256, 257, 300, 65535, 65536, 65536 + 7, 70000, (1ull << 24) + 3, (1ull << 32) + 9 };
+	std::vector<TimerWheel<uint64_t>::TimerId> ids;
+	for (uint64_t expire : expires) {
+		uint64_t payload = expire;
+		ids.push_back(wheel.add(expire, std::move(payload)));
+	}
+	uint64_t cancelled = 300;
+	assert(wheel.cancel(ids[5]));
+	assert(!wheel.cancel(ids[5]));
+
+	uint64_t periodic = 0;
+	wheel.add(100, std::move(periodic));  // 负载为 0 的是周期定时器，每 100 刻度一次，共 5 次
+
+	std::vector<uint64_t> fired;
+	size_t rounds = 0;
+	std::minstd_rand rng(8);
+	auto on_expire = [&](uint64_t &payload, uint64_t expire) -> uint64_t {
+		assert(wheel.current() == expire);
+		if (payload != 0) {
+			assert(payload == expire);
+			fired.push_back(expire);
+			return 0;
+		}
+		return ++rounds < 5 ? expire + 100 : 0;
+	};
+	for (uint64_t now = 0; now < (1ull << 32); now += 1 + rng() % 50000) {
+		wheel.advance(now, on_expire);
+		if (now > 1000000) {
+			now += 1ull << 26;  // 远期定时器之前大步推进
+		}
+	}
+	wheel.advance((1ull << 32) + 100, on_expire);
+
+	assert(rounds == 5);
+	assert(wheel.empty());
+	assert(fired.size() == sizeof(expires) / sizeof(expires[0]) - 1);
+	for (size_t i = 0; i < fired.size(); ++i) {
+		assert(fired[i] != cancelled);
+		assert(i == 0 || fired[i - 1] < fired[i]);
+	}
+
+	// 线程池中的定时任务: 延迟任务不早于延迟时刻执行，周期任务重复执行，取消后不再执行
+	ThreadPool pool(2);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::promise<std::chrono::steady_clock::time_point> once;
+	std::future<std::chrono::steady_clock::time_point> once_future = once.get_future();
+	pool.schedule_after(std::chrono::milliseconds(30), [&once]() { once.set_value(std::chrono::steady_clock::now()); });
+	std::atomic<int> ticks(0);
+	ThreadPool::TimerId every = pool.schedule_every(std::chrono::milliseconds(5), [&ticks]() { ticks++; });
+	ThreadPool::TimerId never = pool.schedule_after(std::chrono::seconds(10), []() { assert(false); });
+	assert(pool.cancel_timer(never));
+
+	assert(once_future.get() - start >= std::chrono::milliseconds(30));
+	while (ticks < 3) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	assert(pool.cancel_timer(every));
+	assert(pool.getTimersAmount() == 0);
+	std::cout << "定时任务: 通过" << std::endl;
+}
+
+// 取得 future 的结果，任务未执行时返回未执行的原因
+template <typename Future>
+bool abortedWith(Future &future, TaskAbortReason reason) {
+	try {
+		future.get();
+	}
+	catch (const TaskAborted &e) {
+		return e.reason() == reason;
+	}
+	return false;
+}
+
+// 取消与截止时间: 排队期间取消或过期的任务不执行，future 得到对应原因；提交时已取消的任务直接拒绝
+void testCancellation() {
+	ThreadPool pool(1);
+	pool.setTaskMaxAmount(8);
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	pool.post([blocked]() { blocked.wait(); });  // 占住唯一的工作线程，之后的任务都在排队
+
+	CancellationToken token;
+	std::atomic<int> executed(0);
+	auto cancelled = pool.submitTask(TaskOptions().setToken(token), [&executed]() { executed++; });
+	auto expired = pool.submitTask(TaskOptions().setTimeout(std::chrono::milliseconds(5)), [&executed]() { executed++; });
+	auto kept = pool.submitTask(TaskOptions().setTimeout(std::chrono::seconds(60)), [&executed]() { executed++; return 1; });
+
+	token.cancel();
+	assert(token.isCancelled());
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	gate.set_value();
+
+	assert(abortedWith(cancelled, TaskAbortReason::CANCELLED));
+	assert(abortedWith(expired, TaskAbortReason::EXPIRED));
+	assert(kept.get() == 1);
+	assert(executed == 1);
+
+	// 提交时已取消: post 返回 false，submitTask 的 future 立即就绪
+	assert(!pool.post(TaskOptions().setToken(token), [&executed]() { executed++; }));
+	auto rejected = pool.submitTask(TaskOptions().setToken(token), [&executed]() { executed++; });
+	assert(rejected.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	assert(abortedWith(rejected, TaskAbortReason::CANCELLED));
+	assert(executed == 1);
+	std::cout << "取消与截止时间: 通过" << std::endl;
+}
+
+// 优先级队列: 高优先级先出，同一优先级先进先出；启用老化后，持续涌入的高优先级任务不会饿死低优先级任务
+void testPriorityAging() {
+	SafeQueue<int> queue;
+	int values[] = { 10, 11, 30, 31, 20, 21, 100 };
+	size_t priorities[] = { 1, 1, 3, 3, 2, 2, 1000 };  // 超过 LEVELS - 1 的优先级按最高级处理
+	for (size_t i = 0; i < 7; ++i) {
+		assert(queue.taskEnqueue(values[i], priorities[i]));
+	}
+	const int expected[] = { 100, 30, 31, 20, 21, 10, 11 };
+	for (int e : expected) {
+		int value = 0;
+		assert(queue.taskDequeue(value) && value == e);
+	}
+	assert(queue.empty());
+
+	// 每取出一个任务就补充一个高优先级任务: 不老化时低优先级任务一直得不到执行，老化间隔为 4 时最多等待 4 次出队
+	const size_t agings[] = { 0, 4 };
+	for (size_t aging : agings) {
+		queue.setAging(aging);
+		int low = -1;
+		assert(queue.taskEnqueue(low, 0));
+		for (int i = 0; i < 8; ++i) {
+			int high = i;
+			queue.taskEnqueue(high, 50);
+		}
+
+		size_t waited = 0;
+		int value = 0;
+		for (; waited < 100; ++waited) {
+			assert(queue.taskDequeue(value));
+			if (value == -1)
+				break;
+			int high = 100 + (int)waited;
+			queue.taskEnqueue(high, 50);
+		}
+		if (aging == 0)
+			assert(value != -1);
+		else
+			assert(value == -1 && waited < aging);
+
+		while (queue.taskDequeue(value)) { }
+	}
+
+	// 线程池: 工作线程空闲后按优先级取出排队的任务
+	ThreadPool pool(1);
+	pool.setTaskMaxAmount(8);
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	pool.post([blocked]() { blocked.wait(); });
+	while (pool.getPendingTasksAmount() > 0) {
+		std::this_thread::yield();
+	}
+
+	std::mutex mutex;
+	std::vector<size_t> order;
+	const size_t levels[] = { 1, 5, 3 };
+	std::vector<std::future<void>> futures;
+	for (size_t level : levels) {
+		pool.setTaskPriority(level);
+		futures.push_back(pool.submitTask([&mutex, &order, level]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			order.push_back(level);
+		}));
+	}
+	gate.set_value();
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+	assert(order.size() == 3 && order[0] == 5 && order[1] == 3 && order[2] == 1);
+	std::cout << "优先级与老化: 通过" << std::endl;
+}
+
+// strand: 同一个 strand 的任务按提交顺序逐个执行，不会并发；执行任务提交超时时在提交线程执行，任务不丢失
+void testStrandOrdering() {
+	ThreadPool pool(4);
+	pool.setTaskMaxAmount(1024);
+
+	const int strands = 4, per_strand = 2000;
+	std::vector<Strand> list;
+	std::vector<std::vector<int>> logs(strands);
+	std::vector<std::atomic<int>> active(strands);
+	std::atomic<bool> overlapped(false);
+	for (int s = 0; s < strands; ++s) {
+		list.emplace_back(pool);
+		active[s] = 0;
+	}
+
+	std::vector<std::future<void>> last;
+	for (int i = 0; i < per_strand; ++i) {
+		for (int s = 0; s < strands; ++s) {
+			Strand &strand = list[s];
+			auto f = strand.submitTask([&, s, i]() {
+				if (active[s]++ != 0)
+					overlapped = true;
+				assert(list[s].runningInThisThread());
+				logs[s].push_back(i);  // 同一 strand 的任务不并发，无需加锁
+				active[s]--;
+			});
+			if (i == per_strand - 1)
+				last.push_back(std::move(f));
+		}
+	}
+	for (std::future<void> &f : last) {
+		f.get();
+	}
+
+	assert(!overlapped);
+	for (int s = 0; s < strands; ++s) {
+		assert((int)logs[s].size() == per_strand);
+		for (int i = 0; i < per_strand; ++i) {
+			assert(logs[s][i] == i);
+		}
+	}
+
+	// 任务队列已满且提交超时: 任务在提交线程按顺序执行
+	ThreadPool full(1);
+	full.setTaskMaxAmount(1);
+	full.setTaskTimeoutByMilliseconds(std::chrono::milliseconds(10));
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	full.post([blocked]() { blocked.wait(); });
+	while (full.getPendingTasksAmount() > 0) {
+		std::this_thread::yield();
+	}
+	full.post([]() { });
+
+	Strand strand(full);
+	std::vector<int> inline_log;
+	for (int i = 0; i < 5; ++i) {
+		assert(strand.post([&inline_log, i]() { inline_log.push_back(i); }));
+	}
+	assert(inline_log.size() == 5 && strand.getPendingTasksAmount() == 0);
+	for (int i = 0; i < 5; ++i) {
+		assert(inline_log[i] == i);
+	}
+	gate.set_value();
+	std::cout << "strand 顺序: 通过" << std::endl;
+}
+
+// 忙等指定时长，模拟耗时相同的计算任务
+void spinFor(std::chrono::microseconds duration) {
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < end) { }
+}
+
+// 动态线程: 持续积压时增加线程但不超过上限；协作式等待中的线程不算空闲；空闲约 2 秒后逐个减少到下限
+void testMutableThreads() {
+	const size_t hw = std::thread::hardware_concurrency();
+	const size_t min_threads = std::min<size_t>(2, hw), max_threads = std::min<size_t>(4, hw);
+	if (min_threads == max_threads) {
+		std::cout << "动态线程: 跳过 (CPU 数量不足)" << std::endl;
+		return ;
+	}
+
+	ThreadPool pool(2, ThreadPoolWorkMode::MUTABLE_THREAD);
+	assert(pool.setTaskMaxAmount(1024));
+	assert(pool.getThreadsAmount() == min_threads);
+
+	// 积压 1.5 秒
+	size_t peak = 0;
+	auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+	while (std::chrono::steady_clock::now() < until) {
+		while (pool.getPendingTasksAmount() < 64) {
+			pool.post([]() { spinFor(std::chrono::microseconds(500)); });
+		}
+		peak = std::max(peak, pool.getThreadsAmount());
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	while (pool.getPendingTasksAmount() > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	assert(peak > min_threads && peak <= max_threads);
+
+	// 全部线程在 wait() 中等待另一个 future: 期间不减少线程，结束后也不会立即减少
+	size_t threads = pool.getThreadsAmount();
+	if (threads > min_threads) {
+		std::promise<void> gate;
+		std::shared_future<void> blocked = gate.get_future().share();
+		std::atomic<size_t> waiting(0);
+		for (size_t i = 0; i < threads; ++i) {
+			pool.post([&pool, blocked, &waiting]() {
+				waiting++;
+				pool.wait(blocked);
+			});
+		}
+		while (waiting < threads) {
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(3000));  // 超过减少线程所需的空闲时长
+		threads = pool.getThreadsAmount();
+		gate.set_value();
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		assert(pool.getThreadsAmount() == threads);
+	}
+
+	// 空闲后减少到下限
+	until = std::chrono::steady_clock::now() + std::chrono::seconds(15);
+	while (pool.getThreadsAmount() > min_threads && std::chrono::steady_clock::now() < until) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	assert(pool.getThreadsAmount() == min_threads);
+	std::cout << "动态线程: 通过" << std::endl;
+}
+
+// 对象池中的对象，记录析构次数
+struct Pooled {
+	static std::atomic<int> destroyed;
+	std::string name;
+	int value[8];
+	explicit Pooled(int v) : name("pooled") { std::fill(this->value, this->value + 8, v); }
+	~Pooled() { destroyed++; }
+};
+std::atomic<int> Pooled::destroyed(0);
+
+// 任务内存区: 只在工作线程中可用，任务之间整体重置 (地址复用)；协作式等待中执行的任务只回退自己的部分；
+// 对象池的对象可以在其他线程释放，释放后的内存块由释放线程复用
+void testTaskArena() {
+	assert(TaskArena::current() == nullptr);
+
+	ThreadPool pool(1, ThreadPoolWorkMode::FIXED_THREAD);
+	auto first = pool.submitTask([]() {
+		TaskArena *arena = TaskArena::current();
+		assert(arena != nullptr && arena->used() == 0);
+		int *p = arena->create<int>(1);
+		assert(*p == 1 && arena->used() >= sizeof(int));
+		return (void*)p;
+	});
+	void *first_address = first.get();
+	auto second = pool.submitTask([]() {
+		TaskArena *arena = TaskArena::current();
+		assert(arena->used() == 0);  // 上一个任务结束时已重置
+		return arena->allocate(sizeof(int), alignof(int));
+	});
+	assert(second.get() == first_address);
+
+	// 外层任务等待子任务时，同一个 (唯一的) 工作线程在 get() 中执行子任务
+	auto outer = pool.submitTask([&pool]() {
+		TaskArena *arena = TaskArena::current();
+		std::vector<int, ArenaAllocator<int>> kept(256, 7);
+		size_t used = arena->used();
+
+		const int *outer_data = kept.data();
+		auto inner = pool.submitTask([outer_data]() {
+			TaskArena *arena = TaskArena::current();
+			int *scratch = static_cast<int*>(arena->allocate(1024 * sizeof(int), alignof(int)));
+			assert(scratch >= outer_data + 256 || scratch + 1024 <= outer_data);  // 不覆盖外层任务的内存
+			std::fill(scratch, scratch + 1024, -1);
+			arena->allocate(TaskArena::CHUNK_SIZE, 16);  // 单独分配的大块内存同样回退
+			return true;
+		});
+		assert(pool.get(inner));
+
+		assert(arena->used() == used);  // 只回退到子任务开始时的位置
+		assert(std::count(kept.begin(), kept.end(), 7) == 256);
+		int *next = arena->create<int>(3);
+		return next >= kept.data() + 256;
+	});
+	assert(outer.get());
+
+	// 对象池: 在其他线程释放
+	const int amount = 256;
+	std::vector<ObjectPool<Pooled>::Ptr> objects;
+	std::vector<Pooled*> addresses;
+	for (int i = 0; i < amount; ++i) {
+		objects.push_back(ObjectPool<Pooled>::make(i));
+		addresses.push_back(objects.back().get());
+		assert(objects.back()->value[7] == i);
+	}
+	Pooled::destroyed = 0;
+	std::thread releaser([&objects, &addresses]() {
+		objects.clear();
+		auto reused = ObjectPool<Pooled>::make(-1);
+		assert(std::find(addresses.begin(), addresses.end(), reused.get()) != addresses.end());
+	});
+	releaser.join();
+	assert(Pooled::destroyed == amount + 1);
+	std::cout << "任务内存区与对象池: 通过" << std::endl;
+}
+
+// 阻塞区域: 全部工作线程都在阻塞区域中时，补偿线程执行新任务；嵌套的阻塞区域只补偿一次；离开后补偿线程退出
+void testBlockingRegion() {
+	ThreadPool pool(2, ThreadPoolWorkMode::FIXED_THREAD);
+	const size_t threads = pool.getThreadsAmount();
+
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	std::atomic<size_t> inside(0);
+	for (size_t i = 0; i < threads; ++i) {
+		pool.post([blocked, &inside]() {
+			ThreadPool::blocking_region region;
+			{
+				ThreadPool::blocking_region nested;
+				inside++;
+				blocked.wait();
+			}
+		});
+	}
+	while (inside < threads) {
+		std::this_thread::yield();
+	}
+	assert(pool.getThreadsAmount() == 2 * threads);
+
+	auto extra = pool.submitTask([]() { return 7; });
+	assert(extra.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+	assert(extra.get() == 7);
+
+	// 阻塞区域外 (非工作线程) 不补偿
+	{
+		ThreadPool::blocking_region outside;
+		assert(pool.getThreadsAmount() == 2 * threads);
+	}
+
+	gate.set_value();
+	auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (pool.getThreadsAmount() > threads && std::chrono::steady_clock::now() < until) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	assert(pool.getThreadsAmount() == threads);
+	assert(pool.submitTask([]() { return 1; }).get() == 1);
+	std::cout << "阻塞区域: 通过" << std::endl;
+}
+
+// 绑核顺序: 两个 NUMA 节点，每个节点两个物理核心，每个核心两个超线程 (节点 0: 0,4 / 1,5；节点 1: 2,6 / 3,7)
+void testCpuOrder() {
+	std::vector<CpuTopology::Cpu> cpus;
+	for (int id = 0; id < 8; ++id) {
+		cpus.push_back(CpuTopology::Cpu{ id, (id % 4) / 2, id % 4 });
+	}
+	std::reverse(cpus.begin(), cpus.end());  // 给定顺序无关
+	CpuTopology topology(cpus);
+	assert(topology.size() == 8 && topology.nodes() == 2);
+	assert(topology.nodeOf(6) == 1 && topology.nodeOf(5) == 0 && topology.nodeOf(99) == 0);
+
+	assert(topology.order(AffinityMode::NONE, std::vector<int>()).empty());
+	assert(topology.order(AffinityMode::COMPACT, std::vector<int>()) == std::vector<int>({ 0, 4, 1, 5, 2, 6, 3, 7 }));
+	assert(topology.order(AffinityMode::SCATTER, std::vector<int>()) == std::vector<int>({ 0, 2, 1, 3, 4, 6, 5, 7 }));
+
+	// 显式: 保持给定顺序，不可用的编号被丢弃
+	assert(topology.order(AffinityMode::EXPLICIT, std::vector<int>({ 7, 9, -1, 3, 0 })) == std::vector<int>({ 7, 3, 0 }));
+	assert(topology.order(AffinityMode::EXPLICIT, std::vector<int>({ 8, 100 })).empty());
+
+	// 单个节点、没有超线程
+	CpuTopology flat(std::vector<CpuTopology::Cpu>({ { 2, 0, 2 }, { 0, 0, 0 }, { 1, 0, 1 } }));
+	assert(flat.nodes() == 1);
+	assert(flat.order(AffinityMode::COMPACT, std::vector<int>()) == std::vector<int>({ 0, 1, 2 }));
+	assert(flat.order(AffinityMode::SCATTER, std::vector<int>()) == std::vector<int>({ 0, 1, 2 }));
+	std::cout << "绑核顺序: 通过" << std::endl;
+}
+
+// 执行组: 两组都有积压时按权重 (3:1) 分配执行时间；并发上限有效；执行槽提交失败时只拒绝本任务
+void testGroupFairness() {
+	ThreadPool pool(1);
+	std::promise<void> gate;
+	std::shared_future<void> blocked = gate.get_future().share();
+	pool.post([blocked]() { blocked.wait(); });  // 先让两组都积压，再开始执行
+
+	GroupScheduler scheduler(pool);
+	scheduler.setMaxSlots(1);
+	ExecutorGroup heavy = scheduler.addGroup("heavy", 3);
+	ExecutorGroup light = scheduler.addGroup("light", 1);
+
+	const int per_group = 200;
+	std::mutex mutex;
+	std::vector<char> order;
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < per_group; ++i) {
+		futures.push_back(heavy.submitTask([&mutex, &order]() {
+			spinFor(std::chrono::microseconds(100));
+			std::unique_lock<std::mutex> lock(mutex);
+			order.push_back('h');
+		}));
+		futures.push_back(light.submitTask([&mutex, &order]() {
+			spinFor(std::chrono::microseconds(100));
+			std::unique_lock<std::mutex> lock(mutex);
+			order.push_back('l');
+		}));
+	}
+	gate.set_value();
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+
+	int heavy_first = (int)std::count(order.begin(), order.begin() + 100, 'h');
+	assert(heavy_first >= 60 && heavy_first <= 90);  // 理想值为 75
+	assert(heavy.getPendingTasksAmount() == 0 && light.getPendingTasksAmount() == 0);
+
+	// 并发上限: 上限为 1 的组在多线程的线程池中也不会同时执行两个任务
+	ThreadPool wide(4);
+	GroupScheduler capped(wide);
+	ExecutorGroup serial = capped.addGroup("serial", 1, 1);
+	std::atomic<int> running(0);
+	std::atomic<bool> exceeded(false);
+	std::vector<std::future<void>> serial_futures;
+	for (int i = 0; i < 200; ++i) {
+		serial_futures.push_back(serial.submitTask([&running, &exceeded]() {
+			if (running++ != 0)
+				exceeded = true;
+			spinFor(std::chrono::microseconds(20));
+			running--;
+		}));
+	}
+	for (std::future<void> &f : serial_futures) {
+		f.get();
+	}
+	assert(!exceeded);
+
+	// 任务队列已满且提交超时: 只有本任务被拒绝
+	ThreadPool full(1);
+	full.setTaskMaxAmount(1);
+	full.setTaskTimeoutByMilliseconds(std::chrono::milliseconds(10));
+	std::promise<void> full_gate;
+	std::shared_future<void> full_blocked = full_gate.get_future().share();
+	full.post([full_blocked]() { full_blocked.wait(); });
+	while (full.getPendingTasksAmount() > 0) {
+		std::this_thread::yield();
+	}
+	full.post([]() { });
+
+	GroupScheduler rejecting(full);
+	ExecutorGroup group = rejecting.addGroup("group", 1);
+	auto rejected = group.submitTask([]() { return 1; });
+	assert(abortedWith(rejected, TaskAbortReason::REJECTED));
+	assert(group.getPendingTasksAmount() == 0);
+	full_gate.set_value();
+	assert(group.submitTask([]() { return 2; }).get() == 2);
+	std::cout << "执行组公平性: 通过" << std::endl;
+}
+
+
 int main() {
+	// 行为测试，失败时 assert 终止
+	testNestedGet();
+	testNestedBatch();
+	testWorkStealing();
+	testLockFreeQueue();
+	testFutureCombinators();
+	testParallelAlgorithms();
+	testTimerWheel();
+	testCancellation();
+	testPriorityAging();
+	testStrandOrdering();
+	testTaskArena();
+	testBlockingRegion();
+	testCpuOrder();
+	testGroupFairness();
+	testMutableThreads();
+
 	// 创建线程池
 	ThreadPool pool(3, ThreadPoolWorkMode::MUTABLE_THREAD);
 
@@ -92,5 +983,12 @@ int main() {
 		
 	// 关闭线程池，可手动关闭，也可自动关闭
 	pool.close();
+
+	// 运行统计，随时可以获取，不会暂停工作线程
+	ThreadPoolStats stats = pool.stats();
+	std::cout << "submitted: " << stats.submitted << "  executed: " << stats.executed << "  stolen: " << stats.stolen
+		<< "  rejected: " << stats.rejected << "  timed out: " << stats.timed_out << '\n'
+		<< "queue wait p99: " << ThreadPoolStats::percentile(stats.queue_wait, 0.99) << " ns  "
+		<< "run time p99: " << ThreadPoolStats::percentile(stats.run_time, 0.99) << " ns" << std::endl;
 	return 0;
 }